@@ -18,6 +18,9 @@ struct zmk_behavior_binding {
     zmk_behavior_local_id_t local_id;
 #endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
     const char *behavior_dev;
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+    const struct device *behavior_dev_cache;
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
     uint32_t param1;
     uint32_t param2;
 };
@@ -45,6 +48,27 @@ struct zmk_behavior_binding_event {
  */
 const struct device *zmk_behavior_get_binding(const char *name);
 
+/**
+ * @brief Get the behavior device for a binding, using its cached device if it has been resolved.
+ *
+ * @param binding Behavior binding to get the device for.
+ *
+ * @retval Pointer to the device structure for the binding's behavior.
+ * @retval NULL if the behavior is not found or its initialization function failed.
+ */
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding);
+
+/**
+ * @brief Look up the behavior device for a binding and cache it in the binding, so that later
+ * invocations of it don't need to search for the behavior by name.
+ *
+ * @param binding Behavior binding to resolve.
+ *
+ * @retval 0 If successful, or if caching devices in bindings is not enabled.
+ * @retval -ENODEV if the behavior is not found or its initialization function failed.
+ */
+int zmk_behavior_resolve_binding_device(struct zmk_behavior_binding *binding);
+
 /**
  * @brief Invoke a behavior given its binding and invoking event details.
  *
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+enum zmk_benchmark_stage {
+    ZMK_BENCHMARK_STAGE_KSCAN,
+    ZMK_BENCHMARK_STAGE_POSITION,
+    ZMK_BENCHMARK_STAGE_KEYMAP,
+    ZMK_BENCHMARK_STAGE_HID,
+    ZMK_BENCHMARK_STAGE_ENDPOINT,
+    ZMK_BENCHMARK_STAGE_COUNT,
+};
+
+#if IS_ENABLED(CONFIG_ZMK_BENCHMARK)
+
+/**
+ * @brief Record that the event currently moving through the key event pipeline reached @p stage.
+ *
+ * A ZMK_BENCHMARK_STAGE_KSCAN mark starts a new sample, and a ZMK_BENCHMARK_STAGE_ENDPOINT mark
+ * completes it and records its end to end latency.
+ */
+void zmk_benchmark_mark(enum zmk_benchmark_stage stage);
+
+/**
+ * @brief Print the collected per-stage timings and latency percentiles as JSON lines.
+ */
+void zmk_benchmark_report(void);
+
+#else
+
+static inline void zmk_benchmark_mark(enum zmk_benchmark_stage stage) {}
+
+static inline void zmk_benchmark_report(void) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_BENCHMARK)
@@ -11,7 +11,7 @@
 
 #define ZMK_BLE_IS_CENTRAL                                                                         \
     (IS_ENABLED(CONFIG_ZMK_SPLIT) && IS_ENABLED(CONFIG_ZMK_BLE) &&                                 \
-     IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL))
+     IS_ENABLED(CONFIG_ZMK_SPLIT_BLE) && IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL))
 
 #if ZMK_BLE_IS_CENTRAL
 #define ZMK_BLE_PROFILE_COUNT (CONFIG_BT_MAX_PAIRED - CONFIG_ZMK_SPLIT_BLE_CENTRAL_PERIPHERALS)
@@ -37,10 +37,33 @@ bool zmk_ble_active_profile_is_open(void);
 bool zmk_ble_active_profile_is_connected(void);
 char *zmk_ble_active_profile_name(void);
 
+struct bt_conn *zmk_ble_profile_conn(uint8_t index);
+bool zmk_ble_profile_is_connected(uint8_t index);
+
+/**
+ * Get whether reports are mirrored to every connected profile.
+ */
+bool zmk_ble_mirror_is_enabled(void);
+
+/**
+ * Enable or disable mirroring reports to every connected profile, instead of only the active one.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if multiple connections are not enabled.
+ */
+int zmk_ble_set_mirror(bool enabled);
+int zmk_ble_toggle_mirror(void);
+
+/**
+ * Get a bit mask of the profiles that reports are sent to. This is the active profile, plus every
+ * other connected profile while mirroring is enabled.
+ */
+uint32_t zmk_ble_output_profiles(void);
+
 int zmk_ble_unpair_all(void);
 
 int zmk_ble_set_device_name(char *name);
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#if ZMK_BLE_IS_CENTRAL
 int zmk_ble_put_peripheral_addr(const bt_addr_le_t *addr);
-#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) */
+#endif /* ZMK_BLE_IS_CENTRAL */
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/matrix.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/keycode_state_changed.h>
+
+/**
+ * A fixed-capacity FIFO of events that were captured by a listener while it defers a decision,
+ * e.g. while a hold-tap is undecided.
+ *
+ * Captured events are copied into the ring once and later re-raised in place from their ring
+ * slot, in capture order. Events that are captured again while a replay is in progress (e.g. by
+ * a hold-tap that became undecided during the replay) are appended behind the events still being
+ * replayed, and a nested replay only touches those newer events.
+ */
+
+enum zmk_captured_event_tag {
+    ZMK_CAPTURED_EVENT_NONE,
+    ZMK_CAPTURED_EVENT_POSITION,
+    ZMK_CAPTURED_EVENT_KEYCODE,
+};
+
+struct zmk_captured_event {
+    enum zmk_captured_event_tag tag;
+    union {
+        struct zmk_position_state_changed_event position;
+        struct zmk_keycode_state_changed_event keycode;
+    } data;
+};
+
+#define ZMK_CAPTURED_EVENTS_POSITION_WORDS DIV_ROUND_UP(ZMK_KEYMAP_LEN, 32)
+
+struct zmk_captured_events {
+    struct zmk_captured_event *events;
+    uint16_t capacity;
+    // Index of the oldest event that has not been handed to a replay yet.
+    uint16_t head;
+    // Number of events captured since the last replay started.
+    uint16_t len;
+    // Index of the oldest slot handed to a replay that is still in progress.
+    uint16_t tail;
+    // Number of slots from tail up to head. These must not be overwritten until every replay that
+    // owns one of them is done, even if a nested replay already freed some of them.
+    uint16_t reserved;
+    // Number of events that could not be captured because the ring was full, logged on overflow.
+    uint32_t overflows;
+    // Positions with a captured key down event among the len pending events.
+    uint32_t keydown_positions[ZMK_CAPTURED_EVENTS_POSITION_WORDS];
+};
+
+#define ZMK_CAPTURED_EVENTS_DEFINE(name, size)                                                     \
+    BUILD_ASSERT((size) > 0 && (size) <= UINT16_MAX,                                               \
+                 "Captured event ring size must be between 1 and UINT16_MAX");                     \
+    static struct zmk_captured_event _CONCAT(name, _events)[size];                                 \
+    static struct zmk_captured_events name = {                                                     \
+        .events = _CONCAT(name, _events),                                                          \
+        .capacity = (size),                                                                        \
+    }
+
+typedef void (*zmk_captured_event_replay_cb)(struct zmk_captured_event *ev, void *user_data);
+
+/**
+ * Copy a raised position state changed event into the ring.
+ *
+ * @retval 0 on success.
+ * @retval -ENOMEM if the ring is full. The overflow counter is incremented and the caller still
+ * owns the event, so it must not report it as captured.
+ */
+int zmk_captured_events_capture_position(struct zmk_captured_events *ring,
+                                         const struct zmk_position_state_changed *ev);
+
+/**
+ * Copy a raised keycode state changed event into the ring.
+ *
+ * @retval 0 on success.
+ * @retval -ENOMEM if the ring is full, see zmk_captured_events_capture_position.
+ */
+int zmk_captured_events_capture_keycode(struct zmk_captured_events *ring,
+                                        const struct zmk_keycode_state_changed *ev);
+
+/**
+ * Check whether a key down event for the given position is among the events captured since the
+ * last replay started.
+ */
+bool zmk_captured_events_has_keydown(const struct zmk_captured_events *ring, uint32_t position);
+
+/**
+ * Hand all events captured so far to @p cb, oldest first. The event pointer passed to the
+ * callback points into the ring and is only valid until the callback returns, which makes it
+ * suitable for re-raising the event in place.
+ *
+ * @return The number of events replayed.
+ */
+int zmk_captured_events_replay(struct zmk_captured_events *ring, zmk_captured_event_replay_cb cb,
+                               void *user_data);
+
+static inline bool zmk_captured_events_is_empty(const struct zmk_captured_events *ring) {
+    return ring->len == 0;
+}
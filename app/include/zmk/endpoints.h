@@ -8,6 +8,7 @@
 
 #include <zmk/ble.h>
 #include <zmk/endpoints_types.h>
+#include <zmk/hid.h>
 
 /**
  * Recommended length of string buffer for printing endpoint identifiers.
@@ -68,6 +69,24 @@ int zmk_endpoints_toggle_transport(void);
  */
 struct zmk_endpoint_instance zmk_endpoints_selected(void);
 
+/**
+ * Gets the keyboard report type sent to an endpoint. Unless
+ * CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT is enabled, this is always the report type
+ * the firmware was built with.
+ */
+enum zmk_hid_keyboard_report_type
+zmk_endpoints_keyboard_report_type(struct zmk_endpoint_instance endpoint);
+
+/**
+ * Sets the keyboard report type sent to an endpoint. If the endpoint is the
+ * selected one, all held keys are released first so none stay held on the host.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT is not enabled.
+ */
+int zmk_endpoints_set_keyboard_report_type(struct zmk_endpoint_instance endpoint,
+                                           enum zmk_hid_keyboard_report_type type);
+
 int zmk_endpoints_send_report(uint16_t usage_page);
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
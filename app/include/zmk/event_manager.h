@@ -10,8 +10,13 @@
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
 
+struct zmk_event_subscription;
+
 struct zmk_event_type {
     const char *name;
+    // Bounds of this event type's subscriptions, which the linker groups together
+    const struct zmk_event_subscription *subscriptions_start;
+    const struct zmk_event_subscription *subscriptions_end;
 };
 
 typedef struct {
@@ -33,6 +38,12 @@ struct zmk_event_subscription {
     const struct zmk_listener *listener;
 };
 
+// Subscriptions are placed in per-event-type sections that are sorted by name at link time, so
+// that all listeners of a given type end up contiguous and in link order, bracketed by the
+// zero-sized start (".0") and end (".2") markers emitted by ZMK_EVENT_IMPL.
+#define ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, suffix)                                         \
+    __attribute__((__section__(".event_subscription." STRINGIFY(event_type) "." suffix)))
+
 #define ZMK_EVENT_DECLARE(event_type)                                                              \
     struct event_type##_event {                                                                    \
         zmk_event_t header;                                                                        \
@@ -44,7 +55,15 @@ struct zmk_event_subscription {
     extern const struct zmk_event_type zmk_event_##event_type;
 
 #define ZMK_EVENT_IMPL(event_type)                                                                 \
-    const struct zmk_event_type zmk_event_##event_type = {.name = STRINGIFY(event_type)};          \
+    const Z_DECL_ALIGN(struct zmk_event_subscription) zmk_event_subs_start_##event_type[0] __used  \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, "0") = {};                                      \
+    const Z_DECL_ALIGN(struct zmk_event_subscription) zmk_event_subs_end_##event_type[0] __used    \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, "2") = {};                                      \
+    const struct zmk_event_type zmk_event_##event_type = {                                         \
+        .name = STRINGIFY(event_type),                                                             \
+        .subscriptions_start = zmk_event_subs_start_##event_type,                                  \
+        .subscriptions_end = zmk_event_subs_end_##event_type,                                      \
+    };                                                                                             \
     const struct zmk_event_type *zmk_event_ref_##event_type __used                                 \
         __attribute__((__section__(".event_type"))) = &zmk_event_##event_type;                     \
     struct event_type##_event copy_raised_##event_type(const struct event_type *ev) {              \
@@ -67,7 +86,7 @@ struct zmk_event_subscription {
     extern const struct zmk_listener zmk_listener_##mod;                                           \
     const Z_DECL_ALIGN(struct zmk_event_subscription)                                              \
         _CONCAT(_CONCAT(zmk_event_sub_, mod), ev_type) __used                                      \
-        __attribute__((__section__(".event_subscription"))) = {                                    \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(ev_type, "1") = {                                           \
             .event_type = &zmk_event_##ev_type,                                                    \
             .listener = &zmk_listener_##mod,                                                       \
     };
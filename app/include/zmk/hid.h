@@ -76,6 +76,7 @@
 #define ZMK_HID_REPORT_ID_LEDS 0x01
 #define ZMK_HID_REPORT_ID_CONSUMER 0x02
 #define ZMK_HID_REPORT_ID_MOUSE 0x03
+#define ZMK_HID_REPORT_ID_KEYBOARD_HKRO 0x04
 
 #ifndef HID_ITEM_TAG_PUSH
 #define HID_ITEM_TAG_PUSH 0xA
@@ -160,6 +161,38 @@ static const uint8_t zmk_hid_report_desc[] = {
 #endif
 
     HID_END_COLLECTION,
+
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    HID_USAGE_PAGE(HID_USAGE_GEN_DESKTOP),
+    HID_USAGE(HID_USAGE_GD_KEYBOARD),
+    HID_COLLECTION(HID_COLLECTION_APPLICATION),
+    HID_REPORT_ID(ZMK_HID_REPORT_ID_KEYBOARD_HKRO),
+    HID_USAGE_PAGE(HID_USAGE_KEY),
+    HID_USAGE_MIN8(HID_USAGE_KEY_KEYBOARD_LEFTCONTROL),
+    HID_USAGE_MAX8(HID_USAGE_KEY_KEYBOARD_RIGHT_GUI),
+    HID_LOGICAL_MIN8(0x00),
+    HID_LOGICAL_MAX8(0x01),
+
+    HID_REPORT_SIZE(0x01),
+    HID_REPORT_COUNT(0x08),
+    HID_INPUT(ZMK_HID_MAIN_VAL_DATA | ZMK_HID_MAIN_VAL_VAR | ZMK_HID_MAIN_VAL_ABS),
+
+    HID_USAGE_PAGE(HID_USAGE_KEY),
+    HID_REPORT_SIZE(0x08),
+    HID_REPORT_COUNT(0x01),
+    HID_INPUT(ZMK_HID_MAIN_VAL_CONST | ZMK_HID_MAIN_VAL_VAR | ZMK_HID_MAIN_VAL_ABS),
+
+    HID_USAGE_PAGE(HID_USAGE_KEY),
+    HID_LOGICAL_MIN8(0x00),
+    HID_LOGICAL_MAX16(0xFF, 0x00),
+    HID_USAGE_MIN8(0x00),
+    HID_USAGE_MAX8(0xFF),
+    HID_REPORT_SIZE(0x08),
+    HID_REPORT_COUNT(CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE),
+    HID_INPUT(ZMK_HID_MAIN_VAL_DATA | ZMK_HID_MAIN_VAL_ARRAY | ZMK_HID_MAIN_VAL_ABS),
+    HID_END_COLLECTION,
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
     HID_USAGE_PAGE(HID_USAGE_CONSUMER),
     HID_USAGE(HID_USAGE_CONSUMER_CONSUMER_CONTROL),
     HID_COLLECTION(HID_COLLECTION_APPLICATION),
@@ -255,9 +288,10 @@ static const uint8_t zmk_hid_report_desc[] = {
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 };
 
+#define HID_ERROR_ROLLOVER 0x1
+
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 
-#define HID_ERROR_ROLLOVER 0x1
 #define HID_BOOT_KEY_LEN 6
 
 #if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO) &&                                                 \
@@ -289,6 +323,26 @@ struct zmk_hid_keyboard_report {
     struct zmk_hid_keyboard_report_body body;
 } __packed;
 
+enum zmk_hid_keyboard_report_type {
+    ZMK_HID_KEYBOARD_REPORT_TYPE_NKRO,
+    ZMK_HID_KEYBOARD_REPORT_TYPE_HKRO,
+};
+
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+struct zmk_hid_keyboard_hkro_report_body {
+    zmk_mod_flags_t modifiers;
+    uint8_t _reserved;
+    uint8_t keys[CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE];
+} __packed;
+
+struct zmk_hid_keyboard_hkro_report {
+    uint8_t report_id;
+    struct zmk_hid_keyboard_hkro_report_body body;
+} __packed;
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #if IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 
 struct zmk_hid_led_report_body {
@@ -346,6 +400,7 @@ struct zmk_hid_mouse_resolution_feature_report {
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
 zmk_mod_flags_t zmk_hid_get_explicit_mods(void);
+zmk_mod_flags_t zmk_hid_get_implicit_mods(void);
 int zmk_hid_register_mod(zmk_mod_t modifier);
 int zmk_hid_unregister_mod(zmk_mod_t modifier);
 bool zmk_hid_mod_is_pressed(zmk_mod_t modifier);
@@ -387,6 +442,14 @@ void zmk_hid_mouse_clear(void);
 struct zmk_hid_keyboard_report *zmk_hid_get_keyboard_report(void);
 struct zmk_hid_consumer_report *zmk_hid_get_consumer_report(void);
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+/**
+ * Get an HKRO keyboard report built from the current keyboard report. If more keys are held than
+ * it can report, every key slot is set to HID_ERROR_ROLLOVER.
+ */
+struct zmk_hid_keyboard_hkro_report *zmk_hid_get_keyboard_hkro_report(void);
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 zmk_hid_boot_report_t *zmk_hid_get_boot_report();
 #endif
@@ -12,6 +12,10 @@
 int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *body);
 int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *body);
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+int zmk_hog_send_keyboard_hkro_report(struct zmk_hid_keyboard_hkro_report_body *body);
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *body);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
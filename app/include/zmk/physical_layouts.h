@@ -59,4 +59,17 @@ int zmk_physical_layouts_get_position_map(uint8_t source, uint8_t dest, size_t m
  * @retval a negative errno value in the case of errors
  * @retval a positive length of the position map array that map is updated to point to.
  */
-int zmk_physical_layouts_get_selected_to_stock_position_map(uint32_t const **map);
\ No newline at end of file
+int zmk_physical_layouts_get_selected_to_stock_position_map(uint32_t const **map);
+
+struct zmk_physical_layouts_kscan_stats {
+    // Most kscan events that were waiting to be processed at once.
+    uint32_t high_water;
+    // Kscan events dropped because the event queue was full.
+    uint32_t dropped;
+};
+
+/**
+ * @brief Get the kscan event queue statistics since boot, e.g. to size
+ *        CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE. Benchmark runs report them.
+ */
+void zmk_physical_layouts_get_kscan_stats(struct zmk_physical_layouts_kscan_stats *stats);
\ No newline at end of file
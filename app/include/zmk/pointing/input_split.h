@@ -7,4 +7,12 @@
 #pragma once
 
 int zmk_input_split_report_peripheral_event(uint8_t reg, uint8_t type, uint16_t code, int32_t value,
-                                            bool sync);
\ No newline at end of file
+                                            bool sync);
+
+/**
+ * Report a frame of accumulated relative motion from a peripheral as a single group of input
+ * events, with sync set on the last one.
+ *
+ * @param axes Bit mask of the zmk_split_transport_input_frame_axis values to report.
+ */
+int zmk_input_split_report_peripheral_frame(uint8_t reg, uint8_t axes, const int16_t *values);
@@ -6,42 +6,202 @@
 
 #pragma once
 
+#include <errno.h>
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
 #include <zmk/events/sensor_event.h>
 #include <zmk/sensors.h>
-
-#define ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN 9
+#include <zmk/split/transport/types.h>
 
 struct sensor_event {
     uint8_t sensor_index;
+    // 0 for the peripheral's own sensors, or 1 + the index of the peripheral it relayed them for.
+    uint8_t downstream;
 
     uint8_t channel_data_size;
     struct zmk_sensor_channel_data channel_data[ZMK_SENSOR_EVENT_MAX_CHANNELS];
 } __packed;
 
-struct zmk_split_run_behavior_data {
+#define ZMK_SPLIT_KEY_EVENT_PRESSED BIT(15)
+#define ZMK_SPLIT_KEY_EVENT_POSITION_MASK BIT_MASK(15)
+
+/**
+ * A single key position change in a key events notification.
+ */
+struct zmk_split_key_event {
+    // Position in the low 15 bits, ZMK_SPLIT_KEY_EVENT_PRESSED if it was pressed.
+    uint16_t position_state;
+    // Milliseconds since the previous event in the notification.
+    uint8_t time_delta;
+} __packed;
+
+/**
+ * A batch of key position changes, in the order they happened on the peripheral.
+ */
+struct zmk_split_key_events_payload {
+    // Time of the first event on the peripheral's clock, in milliseconds.
+    uint32_t timestamp;
+    // 0 for the peripheral's own keys, or 1 + the index of the peripheral it relayed them for.
+    uint8_t downstream;
+    struct zmk_split_key_event events[];
+} __packed;
+
+/**
+ * A key the peripheral resolved to a key press binding with its own copy of the keymap. Sent
+ * alone on the key events characteristic, and told apart from a key events payload by its size.
+ */
+struct zmk_split_resolved_key_event_payload {
+    uint32_t timestamp;
+    uint8_t downstream;
+    uint16_t position_state;
+    uint32_t keycode;
+    uint32_t layers;
+} __packed;
+
+BUILD_ASSERT((sizeof(struct zmk_split_resolved_key_event_payload) -
+              sizeof(struct zmk_split_key_events_payload)) %
+                     sizeof(struct zmk_split_key_event) !=
+                 0,
+             "Resolved key events must be distinguishable from key events by their size");
+
+/*
+ * The central reads the peripheral's behavior table once it connects. The table is the names of
+ * all of the peripheral's behaviors, each NUL terminated, and a behavior's index in it is the ID
+ * used to invoke it.
+ *
+ * A run behaviors write packs one or more invocations back to back. Each is a header followed by
+ * param1 and then param2, little-endian, using only as many bytes as their size codes say.
+ */
+struct zmk_split_run_behavior_header {
+    uint8_t behavior_id;
     uint8_t position;
     uint8_t source;
-    uint8_t state;
-    uint32_t param1;
-    uint32_t param2;
+    // ZMK_SPLIT_RUN_BEHAVIOR_PRESSED, the param size codes and the downstream peripheral a relay
+    // should forward the invocation to.
+    uint8_t flags;
 } __packed;
 
-struct zmk_split_run_behavior_payload {
-    struct zmk_split_run_behavior_data data;
-    char behavior_dev[ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN];
-} __packed;
+#define ZMK_SPLIT_RUN_BEHAVIOR_PRESSED BIT(0)
+#define ZMK_SPLIT_RUN_BEHAVIOR_PARAM1_SIZE_SHIFT 1
+#define ZMK_SPLIT_RUN_BEHAVIOR_PARAM2_SIZE_SHIFT 3
+#define ZMK_SPLIT_RUN_BEHAVIOR_PARAM_SIZE_MASK 0x3
+#define ZMK_SPLIT_RUN_BEHAVIOR_DOWNSTREAM_SHIFT 5
+#define ZMK_SPLIT_RUN_BEHAVIOR_DOWNSTREAM_MASK 0x7
+
+#define ZMK_SPLIT_RUN_BEHAVIOR_MAX_SIZE                                                            \
+    (sizeof(struct zmk_split_run_behavior_header) + 2 * sizeof(uint32_t))
+
+/**
+ * @return The size code for the smallest of 0, 1, 2 or 4 bytes that holds @p param.
+ */
+static inline uint8_t zmk_split_run_behavior_param_size_code(uint32_t param) {
+    return param == 0 ? 0 : param <= UINT8_MAX ? 1 : param <= UINT16_MAX ? 2 : 3;
+}
+
+static inline size_t zmk_split_run_behavior_param_size(uint8_t size_code) {
+    return size_code == 0 ? 0 : BIT(size_code - 1);
+}
 
 struct zmk_split_input_event_payload {
+    // 0 for the peripheral's own input devices, or 1 + the index of the peripheral it relayed
+    // them for. Input frames carry it the same way.
+    uint8_t downstream;
     uint8_t type;
     uint16_t code;
     uint32_t value;
     uint8_t sync;
 } __packed;
 
-int zmk_split_bt_position_pressed(uint8_t position);
-int zmk_split_bt_position_released(uint8_t position);
-int zmk_split_bt_sensor_triggered(uint8_t sensor_index,
-                                  const struct zmk_sensor_channel_data channel_data[],
-                                  size_t channel_data_size);
+// Sent on the same characteristic as single input events, and told apart by its size.
+struct zmk_split_input_frame_payload {
+    uint8_t downstream;
+    uint8_t axes;
+    int16_t values[ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_COUNT];
+} __packed;
+
+BUILD_ASSERT(sizeof(struct zmk_split_input_frame_payload) !=
+                 sizeof(struct zmk_split_input_event_payload),
+             "Input frames must be distinguishable from input events by their size");
+
+/*
+ * State sync writes start with the version and the fields bit mask, followed by only the fields
+ * in the mask, in bit order: the layers as a little-endian uint32, the HID indicators, the WPM,
+ * and the endpoint transport and BLE profile index.
+ */
+#define ZMK_SPLIT_STATE_SYNC_PAYLOAD_MAX_SIZE (2 + sizeof(uint32_t) + 1 + 1 + 2)
+
+static inline size_t zmk_split_state_sync_encode(const struct zmk_split_transport_state_sync *state,
+                                                 uint8_t *buf) {
+    size_t len = 0;
+
+    buf[len++] = state->version;
+    buf[len++] = state->fields;
+
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_LAYERS) {
+        sys_put_le32(state->layers, &buf[len]);
+        len += sizeof(uint32_t);
+    }
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_HID_INDICATORS) {
+        buf[len++] = state->hid_indicators;
+    }
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_WPM) {
+        buf[len++] = state->wpm;
+    }
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_ENDPOINT) {
+        buf[len++] = state->endpoint_transport;
+        buf[len++] = state->endpoint_ble_profile;
+    }
+
+    return len;
+}
+
+/**
+ * @retval 0 on success.
+ * @retval -ENOTSUP if the payload is from a different state sync version.
+ * @retval -EINVAL if the payload is malformed.
+ */
+static inline int zmk_split_state_sync_decode(const uint8_t *buf, size_t len,
+                                              struct zmk_split_transport_state_sync *state) {
+    if (len < 2) {
+        return -EINVAL;
+    }
+
+    *state = (struct zmk_split_transport_state_sync){.version = buf[0], .fields = buf[1]};
+    if (state->version != ZMK_SPLIT_TRANSPORT_STATE_SYNC_VERSION) {
+        return -ENOTSUP;
+    }
+
+    const uint8_t fields = state->fields;
+    size_t pos = 2;
+
+    if (fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_LAYERS) {
+        if (len < pos + sizeof(uint32_t)) {
+            return -EINVAL;
+        }
+        state->layers = sys_get_le32(&buf[pos]);
+        pos += sizeof(uint32_t);
+    }
+    if (fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_HID_INDICATORS) {
+        if (len < pos + 1) {
+            return -EINVAL;
+        }
+        state->hid_indicators = buf[pos++];
+    }
+    if (fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_WPM) {
+        if (len < pos + 1) {
+            return -EINVAL;
+        }
+        state->wpm = buf[pos++];
+    }
+    if (fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_ENDPOINT) {
+        if (len < pos + 2) {
+            return -EINVAL;
+        }
+        state->endpoint_transport = buf[pos++];
+        state->endpoint_ble_profile = buf[pos++];
+    }
 
-int zmk_split_bt_report_input(uint8_t reg, uint8_t type, uint16_t code, int32_t value, bool sync);
+    return pos == len ? 0 : -EINVAL;
+}
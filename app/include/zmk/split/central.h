@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zmk/behavior.h>
+#include <zmk/hid_indicators_types.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE)
+// Each directly connected peripheral may relay for others, which get their own source IDs.
+#define ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT                                                         \
+    (CONFIG_ZMK_SPLIT_BLE_CENTRAL_PERIPHERALS *                                                    \
+     (1 + CONFIG_ZMK_SPLIT_BLE_CENTRAL_RELAYED_PERIPHERALS))
+#else
+#define ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT 1
+#endif
+
+int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event, bool state);
+
+/**
+ * Get the IDs of the peripherals that are currently connected.
+ *
+ * @param sources Array of at least ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT entries.
+ * @return The number of IDs written.
+ */
+int zmk_split_central_get_available_source_ids(uint8_t *sources);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+int zmk_split_central_update_hid_indicator(zmk_hid_indicators_t indicators);
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+struct zmk_split_central_peripheral_stats {
+    /** Number of events received from the peripheral. */
+    uint32_t events_received;
+    /** Number of events from the peripheral dropped because the event queue was full. */
+    uint32_t events_dropped;
+    /** Number of commands handed to the transport for the peripheral. */
+    uint32_t commands_sent;
+    /** Number of commands the transport failed to send to the peripheral. */
+    uint32_t commands_failed;
+    /** Number of times the peripheral (re)connected. */
+    uint32_t connections;
+    /** Number of key presses the press latency was measured over. */
+    uint32_t presses;
+    /**
+     * Average time in milliseconds from a key press on the peripheral to its arrival, above the
+     * fastest arrival seen on the link. Fixed link latency can't be told apart from clock offset,
+     * so this measures how much presses are delayed beyond the link's best case.
+     */
+    uint32_t press_latency_avg_ms;
+    /** Maximum press latency in milliseconds, see press_latency_avg_ms. */
+    uint32_t press_latency_max_ms;
+};
+
+/**
+ * Get the link statistics for a peripheral.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if the source is out of range.
+ * @retval -ENOTSUP if split statistics are not enabled.
+ */
+int zmk_split_central_get_peripheral_stats(uint8_t source,
+                                           struct zmk_split_central_peripheral_stats *stats);
+
+/**
+ * @return The most events that were waiting in the central's event queue at once, or -ENOTSUP
+ * if split statistics are not enabled.
+ */
+int zmk_split_central_get_event_queue_high_water(void);
+
+/**
+ * Reset the link statistics of all peripherals.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if split statistics are not enabled.
+ */
+int zmk_split_central_reset_stats(void);
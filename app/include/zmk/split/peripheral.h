@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zmk/endpoints_types.h>
+#include <zmk/split/transport/types.h>
+
+/**
+ * Send an event to the central over the active split transport.
+ */
+int zmk_split_peripheral_report_event(const struct zmk_split_transport_peripheral_event *event);
+
+/**
+ * Send a key position change to the central, as the keycode it resolves to with
+ * CONFIG_ZMK_SPLIT_LOCAL_KEYMAP if it is a plain key press binding.
+ */
+int zmk_split_peripheral_report_position(uint32_t position, bool pressed, uint32_t timestamp);
+
+/**
+ * Forward a command from the central to the downstream peripheral it is addressed to, or to all
+ * of them for commands without a single target. Only available with CONFIG_ZMK_SPLIT_RELAY.
+ */
+int zmk_split_relay_forward_command(struct zmk_split_transport_central_command cmd);
+
+/**
+ * The layer state last synced from the central. Only available with CONFIG_ZMK_SPLIT_STATE_SYNC.
+ */
+uint32_t zmk_split_peripheral_get_layer_state(void);
+
+/**
+ * The WPM last synced from the central. Only available with CONFIG_ZMK_SPLIT_STATE_SYNC.
+ */
+uint8_t zmk_split_peripheral_get_wpm(void);
+
+/**
+ * The central's selected endpoint as last synced. Only available with
+ * CONFIG_ZMK_SPLIT_STATE_SYNC.
+ */
+struct zmk_endpoint_instance zmk_split_peripheral_get_endpoint(void);
+
+/**
+ * The HID indicators last synced from the central. Only available with
+ * CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS.
+ */
+zmk_hid_indicators_t zmk_split_peripheral_get_hid_indicators(void);
+
+/**
+ * Resolve a key position change on this peripheral to a key press binding, using its copy of the
+ * keymap and the layers synced from the central. A release resolves to the keycode of its press.
+ * Only available with CONFIG_ZMK_SPLIT_LOCAL_KEYMAP.
+ *
+ * @param keycode Set to the encoded keycode of the binding.
+ * @param layers Set to the layer state the position was resolved with.
+ * @retval 0 if the position resolved to a key press binding.
+ * @retval -ENOENT if the central must handle the position itself.
+ */
+int zmk_split_peripheral_keymap_resolve(uint32_t position, bool pressed, uint32_t *keycode,
+                                        uint32_t *layers);
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zmk/split/transport/types.h>
+
+struct zmk_split_transport_central;
+
+struct zmk_split_transport_central_api {
+    /**
+     * Send a command to the peripheral with the given source ID. May be called from any thread,
+     * so transports must queue the command if sending it can block.
+     */
+    int (*send_command)(uint8_t source, struct zmk_split_transport_central_command cmd);
+
+    /**
+     * Fill sources with the IDs of the peripherals that are currently able to receive commands.
+     *
+     * @return The number of IDs written, at most ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT.
+     */
+    int (*get_available_source_ids)(uint8_t *sources);
+};
+
+struct zmk_split_transport_central {
+    const struct zmk_split_transport_central_api *api;
+};
+
+/**
+ * Hand an event received from a peripheral to the split central. Safe to call from any thread,
+ * the event is processed on the system work queue.
+ *
+ * @retval 0 on success.
+ * @retval -ENOMEM if the event queue is full and the event was dropped.
+ */
+int zmk_split_transport_central_peripheral_event_handler(
+    const struct zmk_split_transport_central *transport, uint8_t source,
+    struct zmk_split_transport_peripheral_event ev);
+
+/**
+ * Tell the split central that a peripheral (re)connected, for link statistics.
+ */
+void zmk_split_transport_central_peripheral_connected(
+    const struct zmk_split_transport_central *transport, uint8_t source);
+
+/**
+ * Ask the split central to send the full synced state to a peripheral, e.g. once it is ready to
+ * receive commands after (re)connecting. Does nothing without CONFIG_ZMK_SPLIT_STATE_SYNC.
+ */
+void zmk_split_transport_central_request_state_sync(
+    const struct zmk_split_transport_central *transport, uint8_t source);
+
+#define ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(name, _api)                                           \
+    const STRUCT_SECTION_ITERABLE(zmk_split_transport_central, name) = {                           \
+        .api = _api,                                                                               \
+    }
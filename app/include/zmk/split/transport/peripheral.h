@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zmk/split/transport/types.h>
+
+struct zmk_split_transport_peripheral;
+
+struct zmk_split_transport_peripheral_api {
+    /**
+     * Send an event to the central. Called from the thread that raised the originating event,
+     * so transports must queue the event if sending it can block.
+     */
+    int (*report_event)(const struct zmk_split_transport_peripheral_event *event);
+};
+
+struct zmk_split_transport_peripheral {
+    const struct zmk_split_transport_peripheral_api *api;
+};
+
+/**
+ * Hand a command received from the central to the split peripheral. Behaviors are invoked from
+ * the calling thread, anything that raises events is deferred to the system work queue.
+ */
+int zmk_split_transport_peripheral_command_handler(
+    const struct zmk_split_transport_peripheral *transport,
+    struct zmk_split_transport_central_command cmd);
+
+#define ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(name, _api)                                        \
+    const STRUCT_SECTION_ITERABLE(zmk_split_transport_peripheral, name) = {                        \
+        .api = _api,                                                                               \
+    }
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/types.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/hid_indicators_types.h>
+#include <zmk/sensors.h>
+
+#define ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN 32
+
+enum zmk_split_transport_peripheral_event_type {
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_FRAME,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT,
+};
+
+/**
+ * Relative axes that are accumulated on the peripheral and sent together in an input frame.
+ */
+enum zmk_split_transport_input_frame_axis {
+    ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_X,
+    ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_Y,
+    ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_WHEEL,
+    ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_HWHEEL,
+    ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_COUNT,
+};
+
+/**
+ * An event sent from a peripheral to the central, independent of how a transport encodes it.
+ */
+struct zmk_split_transport_peripheral_event {
+    uint8_t type;
+    // 0 for an event from the reporting peripheral itself, or 1 + the index of the downstream
+    // peripheral a relay forwarded it for.
+    uint8_t downstream;
+
+    union {
+        struct {
+            uint16_t position;
+            uint8_t pressed;
+            // Time of the change on the peripheral's own clock, in milliseconds. Only differences
+            // between these are meaningful, the central rebases them onto its own clock.
+            uint32_t timestamp;
+        } __packed key_position_event;
+
+        // A key position change the peripheral resolved to a key press binding with its own copy
+        // of the keymap. The central applies the keycode directly if its layer state matches,
+        // and otherwise handles it like a key_position_event.
+        struct {
+            uint16_t position;
+            uint8_t pressed;
+            uint32_t timestamp;
+            // The encoded keycode of the binding, and the layer state it was resolved with.
+            uint32_t keycode;
+            uint32_t layers;
+        } __packed keycode_event;
+
+        struct {
+            uint8_t sensor_index;
+            uint8_t channel_data_size;
+            struct zmk_sensor_channel_data channel_data[ZMK_SENSOR_EVENT_MAX_CHANNELS];
+        } __packed sensor_event;
+
+        struct {
+            uint8_t reg;
+            uint8_t type;
+            uint16_t code;
+            int32_t value;
+            uint8_t sync;
+        } __packed input_event;
+
+        struct {
+            uint8_t reg;
+            // Bit mask of the axes with a value in this frame.
+            uint8_t axes;
+            int16_t values[ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_COUNT];
+        } __packed input_frame;
+    } data;
+} __packed;
+
+enum zmk_split_transport_central_command_type {
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_STATE_SYNC,
+};
+
+// Bumped whenever the fields of the state sync command change.
+#define ZMK_SPLIT_TRANSPORT_STATE_SYNC_VERSION 1
+
+#define ZMK_SPLIT_TRANSPORT_STATE_SYNC_LAYERS BIT(0)
+#define ZMK_SPLIT_TRANSPORT_STATE_SYNC_HID_INDICATORS BIT(1)
+#define ZMK_SPLIT_TRANSPORT_STATE_SYNC_WPM BIT(2)
+#define ZMK_SPLIT_TRANSPORT_STATE_SYNC_ENDPOINT BIT(3)
+
+/**
+ * Central state mirrored on peripherals. Only the fields in the fields bit mask are valid.
+ */
+struct zmk_split_transport_state_sync {
+    uint8_t version;
+    uint8_t fields;
+    uint32_t layers;
+    zmk_hid_indicators_t hid_indicators;
+    uint8_t wpm;
+    // A zmk_transport, and the BLE profile index if it is ZMK_TRANSPORT_BLE.
+    uint8_t endpoint_transport;
+    uint8_t endpoint_ble_profile;
+} __packed;
+
+/**
+ * A command sent from the central to a peripheral, independent of how a transport encodes it.
+ */
+struct zmk_split_transport_central_command {
+    uint8_t type;
+    // 0 for the receiving peripheral itself, or 1 + the index of the downstream peripheral a relay
+    // should forward it to.
+    uint8_t downstream;
+
+    union {
+        struct {
+            uint32_t param1;
+            uint32_t param2;
+            uint8_t position;
+            uint8_t event_source;
+            uint8_t state;
+            char behavior_dev[ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN];
+        } __packed invoke_behavior;
+
+        struct {
+            uint8_t layout_idx;
+        } __packed set_physical_layout;
+
+        struct zmk_split_transport_state_sync state_sync;
+    } data;
+} __packed;
@@ -8,9 +8,66 @@
 
 #include <stdint.h>
 
+struct zmk_usb_hid_queue_stats {
+    /** Number of reports raised since the stats were last reset. */
+    uint32_t queued;
+    /** Number of reports written to the endpoint since the stats were last reset. */
+    uint32_t sent;
+    /** Number of reports the endpoint failed to accept since the stats were last reset. */
+    uint32_t failed;
+    /** Number of reports merged into the newest queued report instead of taking a new slot. */
+    uint32_t collapsed;
+    /** Number of queued reports discarded because the queue was full. */
+    uint32_t dropped;
+    /** Number of reports currently waiting to be sent. */
+    uint8_t depth;
+    /** Maximum number of reports waiting at once since the stats were last reset. */
+    uint8_t max_depth;
+    /**
+     * Average time in microseconds from the oldest state in a report being queued to the host
+     * reading the report.
+     */
+    uint32_t staleness_avg_us;
+    /** Maximum report staleness in microseconds, see staleness_avg_us. */
+    uint32_t staleness_max_us;
+};
+
+struct zmk_usb_hid_stats {
+    struct zmk_usb_hid_queue_stats keyboard;
+    struct zmk_usb_hid_queue_stats consumer;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct zmk_usb_hid_queue_stats mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+    /** Number of USB frames started since the stats were last reset. */
+    uint32_t frames;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+};
+
+/**
+ * Queue the current HID reports for sending over USB. These never block; the reports are
+ * written to the endpoint from a dedicated work queue.
+ */
 int zmk_usb_hid_send_keyboard_report(void);
 int zmk_usb_hid_send_consumer_report(void);
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_usb_hid_send_mouse_report(void);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 void zmk_usb_hid_set_protocol(uint8_t protocol);
+
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+/**
+ * Notify the HID send queue that a USB frame started.
+ */
+void zmk_usb_hid_sof(void);
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+/**
+ * Get the send queue statistics for each USB HID report.
+ */
+void zmk_usb_hid_get_stats(struct zmk_usb_hid_stats *stats);
+
+/**
+ * Reset the send queue statistics for each USB HID report.
+ */
+void zmk_usb_hid_reset_stats(void);
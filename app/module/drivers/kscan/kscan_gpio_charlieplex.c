@@ -63,7 +63,7 @@ struct kscan_charlieplex_data {
      * Current state of the matrix as a flattened 2D array of length
      * (config->cells.length ^2)
      */
-    struct zmk_debounce_state *charlieplex_state;
+    struct zmk_debounce_group *charlieplex_state;
 };
 
 struct kscan_gpio_list {
@@ -245,7 +245,6 @@ static void kscan_charlieplex_read_end(const struct device *dev) {
 static int kscan_charlieplex_read(const struct device *dev) {
     struct kscan_charlieplex_data *data = dev->data;
     const struct kscan_charlieplex_config *config = dev->config;
-    bool continue_scan = false;
 
     // NOTE: RR vs MATRIX: set all pins as input, in case there was a failure on a
     // previous scan, and one of the pins is still set as output
@@ -273,19 +272,7 @@ static int kscan_charlieplex_read(const struct device *dev) {
             const struct gpio_dt_spec *in_gpio = &config->cells.gpios[col];
             const int index = state_index(config, row, col);
 
-            struct zmk_debounce_state *state = &data->charlieplex_state[index];
-            zmk_debounce_update(state, gpio_pin_get_dt(in_gpio), config->debounce_scan_period_ms,
-                                &config->debounce_config);
-
-            // NOTE: RR vs MATRIX: because we don't need an input/output => row/column
-            // setup, we can update in the same loop.
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
-
-                LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
-                data->callback(dev, row, col, pressed);
-            }
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+            zmk_debounce_group_set_raw(data->charlieplex_state, index, gpio_pin_get_dt(in_gpio));
         }
 
         err = kscan_charlieplex_set_as_input(out_gpio);
@@ -297,6 +284,21 @@ static int kscan_charlieplex_read(const struct device *dev) {
 #endif
     }
 
+    zmk_debounce_group_update(data->charlieplex_state, config->debounce_scan_period_ms,
+                              &config->debounce_config);
+
+    // Process the new state.
+    ZMK_DEBOUNCE_GROUP_FOREACH_CHANGED(data->charlieplex_state, index) {
+        const int row = index % config->cells.len;
+        const int col = index / config->cells.len;
+        const bool pressed = zmk_debounce_group_is_pressed(data->charlieplex_state, index);
+
+        LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
+        data->callback(dev, row, col, pressed);
+    }
+
+    const bool continue_scan = zmk_debounce_group_is_active(data->charlieplex_state);
+
     if (continue_scan) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
@@ -438,11 +440,11 @@ static const struct kscan_driver_api kscan_charlieplex_api = {
     BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
                                                                                                    \
-    static struct zmk_debounce_state kscan_charlieplex_state_##n[INST_CHARLIEPLEX_LEN(n)];         \
+    ZMK_DEBOUNCE_GROUP_DEFINE(kscan_charlieplex_state_##n, INST_CHARLIEPLEX_LEN(n));               \
     static const struct gpio_dt_spec kscan_charlieplex_cells_##n[] = {                             \
         LISTIFY(INST_LEN(n), KSCAN_GPIO_CFG_INIT, (, ), n)};                                       \
     static struct kscan_charlieplex_data kscan_charlieplex_data_##n = {                            \
-        .charlieplex_state = kscan_charlieplex_state_##n,                                          \
+        .charlieplex_state = &kscan_charlieplex_state_##n,                                         \
     };                                                                                             \
                                                                                                    \
     static const struct kscan_charlieplex_config kscan_charlieplex_config_##n = {                  \
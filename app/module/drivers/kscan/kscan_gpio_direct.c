@@ -13,6 +13,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/pm/device.h>
+#include <zephyr/sys/__assert.h>
 #include <zephyr/sys/util.h>
 
 #include <zmk/debounce.h>
@@ -67,8 +68,8 @@ struct kscan_direct_data {
 #endif
     /** Timestamp of the current or scheduled scan. */
     int64_t scan_time;
-    /** Current state of the inputs as an array of length config->inputs.len */
-    struct zmk_debounce_state *pin_state;
+    /** Current state of the inputs, indexed by kscan_gpio.index */
+    struct zmk_debounce_group *pin_state;
 };
 
 struct kscan_direct_config {
@@ -173,6 +174,21 @@ static void kscan_direct_read_end(const struct device *dev) {
 #endif
 }
 
+/**
+ * Get the input with the given kscan_gpio.index. The inputs list is sorted by port, not index.
+ */
+static const struct kscan_gpio *kscan_direct_find_input(const struct kscan_direct_data *data,
+                                                        const size_t index) {
+    for (int i = 0; i < data->inputs.len; i++) {
+        if (data->inputs.gpios[i].index == index) {
+            return &data->inputs.gpios[i];
+        }
+    }
+
+    __ASSERT(false, "Invalid input index %zu", index);
+    return NULL;
+}
+
 static int kscan_direct_read(const struct device *dev) {
     struct kscan_direct_data *data = dev->data;
     const struct kscan_direct_config *config = dev->config;
@@ -189,30 +205,27 @@ static int kscan_direct_read(const struct device *dev) {
             return active;
         }
 
-        zmk_debounce_update(&data->pin_state[gpio->index], active, config->debounce_scan_period_ms,
-                            &config->debounce_config);
+        zmk_debounce_group_set_raw(data->pin_state, gpio->index, active);
     }
 
-    // Process the new state.
-    bool continue_scan = false;
+    zmk_debounce_group_update(data->pin_state, config->debounce_scan_period_ms,
+                              &config->debounce_config);
 
-    for (int i = 0; i < data->inputs.len; i++) {
-        const struct kscan_gpio *gpio = &data->inputs.gpios[i];
-        struct zmk_debounce_state *deb_state = &data->pin_state[gpio->index];
+    // Process the new state.
+    ZMK_DEBOUNCE_GROUP_FOREACH_CHANGED(data->pin_state, index) {
+        const bool pressed = zmk_debounce_group_is_pressed(data->pin_state, index);
 
-        if (zmk_debounce_get_changed(deb_state)) {
-            const bool pressed = zmk_debounce_is_pressed(deb_state);
+        LOG_DBG("Sending event at 0,%zu state %s", index, pressed ? "on" : "off");
+        data->callback(dev, 0, index, pressed);
+        if (config->toggle_mode && pressed) {
+            const struct kscan_gpio *gpio = kscan_direct_find_input(data, index);
 
-            LOG_DBG("Sending event at 0,%i state %s", gpio->index, pressed ? "on" : "off");
-            data->callback(dev, 0, gpio->index, pressed);
-            if (config->toggle_mode && pressed) {
-                kscan_inputs_set_flags(&data->inputs, &gpio->spec);
-            }
+            kscan_inputs_set_flags(&data->inputs, &gpio->spec);
         }
-
-        continue_scan = continue_scan || zmk_debounce_is_active(deb_state);
     }
 
+    const bool continue_scan = zmk_debounce_group_is_active(data->pin_state);
+
     if (continue_scan) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
@@ -387,14 +400,14 @@ static const struct kscan_driver_api kscan_direct_api = {
                     (LISTIFY(INST_INPUTS_LEN(n), KSCAN_GPIO_DIRECT_INPUT_CFG_INIT, (, ), n)),      \
                     (LISTIFY(INST_INPUTS_LEN(n), KSCAN_KEY_DIRECT_INPUT_CFG_INIT, (, ), n)))};     \
                                                                                                    \
-    static struct zmk_debounce_state kscan_direct_state_##n[INST_INPUTS_LEN(n)];                   \
+    ZMK_DEBOUNCE_GROUP_DEFINE(kscan_direct_state_##n, INST_INPUTS_LEN(n));                         \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_direct_irq_callback kscan_direct_irqs_##n[INST_INPUTS_LEN(n)];))      \
                                                                                                    \
     static struct kscan_direct_data kscan_direct_data_##n = {                                      \
         .inputs = KSCAN_GPIO_LIST(kscan_direct_inputs_##n),                                        \
-        .pin_state = kscan_direct_state_##n,                                                       \
+        .pin_state = &kscan_direct_state_##n,                                                      \
         COND_INTERRUPTS((.irqs = kscan_direct_irqs_##n, ))};                                       \
                                                                                                    \
     static const struct kscan_direct_config kscan_direct_config_##n = {                            \
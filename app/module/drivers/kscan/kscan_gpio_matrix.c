@@ -14,9 +14,11 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/__assert.h>
+#include <zephyr/sys/math_extras.h>
 #include <zephyr/sys/util.h>
 
 #include <zmk/debounce.h>
+#include <zmk/kscan_gpio_matrix.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -48,7 +50,11 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define USE_POLLING IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_POLLING)
 #define USE_INTERRUPTS (!USE_POLLING)
 
+#define USE_ADAPTIVE_SCAN IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_ADAPTIVE_SCAN)
+#define USE_STATS IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_STATS)
+
 #define COND_INTERRUPTS(code) COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_POLLING, (), code)
+#define COND_STATS(code) COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_STATS, code, ())
 #define COND_POLL_OR_INTERRUPTS(pollcode, intcode)                                                 \
     COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_POLLING, pollcode, intcode)
 
@@ -82,7 +88,29 @@ struct kscan_matrix_data {
      * Current state of the matrix as a flattened 2D array of length
      * (config->rows * config->cols)
      */
-    struct zmk_debounce_state *matrix_state;
+    struct zmk_debounce_group *matrix_state;
+#if USE_ADAPTIVE_SCAN
+    /** Keep scanning at debounce_scan_period_ms until this time once all keys are released. */
+    int64_t burst_end;
+    /** Current scan period while backing off after the burst. */
+    int32_t decay_period_ms;
+    /** Whether the keyboard is idle, see zmk_kscan_gpio_matrix_set_active(). */
+    bool idle;
+#endif
+#if USE_STATS
+    /** Time of the previous scan, or of the interrupt that started scanning. */
+    int64_t prev_scan_time;
+    int64_t stats_start;
+    uint32_t scans;
+    uint32_t presses;
+    uint64_t press_latency_total_ms;
+    uint32_t press_latency_max_ms;
+    /**
+     * When each key was last seen released, as a flattened 2D array of length
+     * (config->rows * config->cols)
+     */
+    uint32_t *press_window_start;
+#endif
 };
 
 struct kscan_matrix_config {
@@ -92,6 +120,7 @@ struct kscan_matrix_config {
     size_t cols;
     int32_t debounce_scan_period_ms;
     int32_t poll_period_ms;
+    int32_t adaptive_burst_ms;
     enum kscan_diode_direction diode_direction;
 };
 
@@ -186,11 +215,79 @@ static void kscan_matrix_irq_callback_handler(const struct device *port, struct
     kscan_matrix_interrupt_disable(data->dev);
 
     data->scan_time = k_uptime_get();
+#if USE_STATS
+    data->prev_scan_time = data->scan_time;
+#endif
 
     k_work_reschedule(&data->work, K_NO_WAIT);
 }
 #endif
 
+#if USE_ADAPTIVE_SCAN
+static void kscan_matrix_start_burst(const struct device *dev) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
+
+    data->burst_end = data->scan_time + config->adaptive_burst_ms;
+    data->decay_period_ms = config->debounce_scan_period_ms;
+}
+
+/**
+ * Get the time until the next scan while all keys are released, or 0 once the burst and decay
+ * are over and the scanner should return to its idle poll period or interrupts.
+ */
+static int32_t kscan_matrix_adaptive_period(const struct device *dev) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
+
+    if (data->idle) {
+        return 0;
+    }
+
+    if (data->scan_time < data->burst_end) {
+        return config->debounce_scan_period_ms;
+    }
+
+    if (data->decay_period_ms >= config->poll_period_ms) {
+        return 0;
+    }
+
+    // Back off by doubling the period on each scan.
+    data->decay_period_ms = MIN(data->decay_period_ms * 2, config->poll_period_ms);
+    return data->decay_period_ms;
+}
+#endif
+
+#if USE_STATS
+/**
+ * Remember when each key that was idle before this scan was last seen released.
+ */
+static void kscan_matrix_record_activity(struct kscan_matrix_data *data) {
+    const struct zmk_debounce_group *group = data->matrix_state;
+
+    for (size_t w = 0; w < ZMK_DEBOUNCE_BITMAP_WORDS(group->len); w++) {
+        uint32_t started = group->raw[w] & ~(group->pressed[w] | group->pending[w]);
+
+        while (started) {
+            const unsigned int bit = u32_count_trailing_zeros(started);
+            started &= started - 1;
+
+            // The key was pressed at some point since the previous scan.
+            data->press_window_start[w * 32 + bit] = (uint32_t)data->prev_scan_time;
+        }
+    }
+}
+
+static void kscan_matrix_record_press(struct kscan_matrix_data *data, const int index,
+                                      const int64_t now) {
+    const uint32_t latency = (uint32_t)now - data->press_window_start[index];
+
+    data->presses++;
+    data->press_latency_total_ms += latency;
+    data->press_latency_max_ms = MAX(data->press_latency_max_ms, latency);
+}
+#endif
+
 static void kscan_matrix_read_continue(const struct device *dev) {
     const struct kscan_matrix_config *config = dev->config;
     struct kscan_matrix_data *data = dev->data;
@@ -201,6 +298,17 @@ static void kscan_matrix_read_continue(const struct device *dev) {
 }
 
 static void kscan_matrix_read_end(const struct device *dev) {
+#if USE_ADAPTIVE_SCAN
+    const int32_t period = kscan_matrix_adaptive_period(dev);
+    if (period > 0) {
+        struct kscan_matrix_data *data = dev->data;
+
+        data->scan_time += period;
+        k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+        return;
+    }
+#endif
+
 #if USE_INTERRUPTS
     // Return to waiting for an interrupt.
     kscan_matrix_interrupt_enable(dev);
@@ -219,6 +327,11 @@ static int kscan_matrix_read(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
     const struct kscan_matrix_config *config = dev->config;
 
+#if USE_STATS
+    const int64_t now = k_uptime_get();
+    data->scans++;
+#endif
+
     // Scan the matrix.
     for (int i = 0; i < config->outputs.len; i++) {
         const struct kscan_gpio *out_gpio = &config->outputs.gpios[i];
@@ -244,8 +357,7 @@ static int kscan_matrix_read(const struct device *dev) {
                 return active;
             }
 
-            zmk_debounce_update(&data->matrix_state[index], active, config->debounce_scan_period_ms,
-                                &config->debounce_config);
+            zmk_debounce_group_set_raw(data->matrix_state, index, active);
         }
 
         err = gpio_pin_set_dt(&out_gpio->spec, 0);
@@ -259,28 +371,41 @@ static int kscan_matrix_read(const struct device *dev) {
 #endif
     }
 
-    // Process the new state.
-    bool continue_scan = false;
+#if USE_STATS
+    kscan_matrix_record_activity(data);
+#endif
 
-    for (int r = 0; r < config->rows; r++) {
-        for (int c = 0; c < config->cols; c++) {
-            const int index = state_index_rc(config, r, c);
-            struct zmk_debounce_state *state = &data->matrix_state[index];
+    zmk_debounce_group_update(data->matrix_state, config->debounce_scan_period_ms,
+                              &config->debounce_config);
 
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
+    // Process the new state.
+    ZMK_DEBOUNCE_GROUP_FOREACH_CHANGED(data->matrix_state, index) {
+        const int r = index % config->rows;
+        const int c = index / config->rows;
+        const bool pressed = zmk_debounce_group_is_pressed(data->matrix_state, index);
 
-                LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
-                data->callback(dev, r, c, pressed);
-            }
+        LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
+        data->callback(dev, r, c, pressed);
 
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+#if USE_STATS
+        if (pressed) {
+            kscan_matrix_record_press(data, index, now);
         }
+#endif
     }
 
+    const bool continue_scan = zmk_debounce_group_is_active(data->matrix_state);
+
+#if USE_STATS
+    data->prev_scan_time = now;
+#endif
+
     if (continue_scan) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
+#if USE_ADAPTIVE_SCAN
+        kscan_matrix_start_burst(dev);
+#endif
         kscan_matrix_read_continue(dev);
     } else {
         // All keys are released. Return to normal.
@@ -311,6 +436,9 @@ static int kscan_matrix_enable(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
 
     data->scan_time = k_uptime_get();
+#if USE_STATS
+    data->prev_scan_time = data->scan_time;
+#endif
 
     // Read will automatically start interrupts/polling once done.
     return kscan_matrix_read(dev);
@@ -328,6 +456,55 @@ static int kscan_matrix_disable(const struct device *dev) {
 #endif
 }
 
+int zmk_kscan_gpio_matrix_set_active(const struct device *dev, bool active) {
+#if USE_ADAPTIVE_SCAN
+    struct kscan_matrix_data *data = dev->data;
+
+    data->idle = !active;
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+int zmk_kscan_gpio_matrix_get_stats(const struct device *dev,
+                                    struct zmk_kscan_gpio_matrix_stats *stats) {
+#if USE_STATS
+    const struct kscan_matrix_data *data = dev->data;
+    const int64_t elapsed_ms = k_uptime_get() - data->stats_start;
+
+    *stats = (struct zmk_kscan_gpio_matrix_stats){
+        .scans = data->scans,
+        .scan_rate_hz =
+            elapsed_ms > 0 ? (uint32_t)((uint64_t)data->scans * MSEC_PER_SEC / elapsed_ms) : 0,
+        .presses = data->presses,
+        .press_latency_avg_ms =
+            data->presses > 0 ? (uint32_t)(data->press_latency_total_ms / data->presses) : 0,
+        .press_latency_max_ms = data->press_latency_max_ms,
+    };
+
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+int zmk_kscan_gpio_matrix_reset_stats(const struct device *dev) {
+#if USE_STATS
+    struct kscan_matrix_data *data = dev->data;
+
+    data->stats_start = k_uptime_get();
+    data->scans = 0;
+    data->presses = 0;
+    data->press_latency_total_ms = 0;
+    data->press_latency_max_ms = 0;
+
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
 static int kscan_matrix_init_input_inst(const struct device *dev, const struct kscan_gpio *gpio) {
     if (!device_is_ready(gpio->spec.port)) {
         LOG_ERR("GPIO is not ready: %s", gpio->spec.port->name);
@@ -453,6 +630,10 @@ static int kscan_matrix_init(const struct device *dev) {
 
     k_work_init_delayable(&data->work, kscan_matrix_work_handler);
 
+#if USE_STATS
+    data->stats_start = k_uptime_get();
+#endif
+
 #if IS_ENABLED(CONFIG_PM_DEVICE)
     pm_device_init_suspended(dev);
 
@@ -504,15 +685,18 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static struct kscan_gpio kscan_matrix_cols_##n[] = {                                           \
         LISTIFY(INST_COLS_LEN(n), KSCAN_GPIO_COL_CFG_INIT, (, ), n)};                              \
                                                                                                    \
-    static struct zmk_debounce_state kscan_matrix_state_##n[INST_MATRIX_LEN(n)];                   \
+    ZMK_DEBOUNCE_GROUP_DEFINE(kscan_matrix_state_##n, INST_MATRIX_LEN(n));                         \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_matrix_irq_callback kscan_matrix_irqs_##n[INST_INPUTS_LEN(n)];))      \
                                                                                                    \
+    COND_STATS((static uint32_t kscan_matrix_press_window_start_##n[INST_MATRIX_LEN(n)];))         \
+                                                                                                   \
     static struct kscan_matrix_data kscan_matrix_data_##n = {                                      \
         .inputs =                                                                                  \
             KSCAN_GPIO_LIST(COND_DIODE_DIR(n, (kscan_matrix_cols_##n), (kscan_matrix_rows_##n))),  \
-        .matrix_state = kscan_matrix_state_##n,                                                    \
+        .matrix_state = &kscan_matrix_state_##n,                                                   \
+        COND_STATS((.press_window_start = kscan_matrix_press_window_start_##n, ))                  \
         COND_INTERRUPTS((.irqs = kscan_matrix_irqs_##n, ))};                                       \
                                                                                                    \
     static const struct kscan_matrix_config kscan_matrix_config_##n = {                            \
@@ -527,6 +711,7 @@ static const struct kscan_driver_api kscan_matrix_api = {
             },                                                                                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
+        .adaptive_burst_ms = DT_INST_PROP(n, adaptive_burst_ms),                                   \
         .diode_direction = INST_DIODE_DIR(n),                                                      \
     };                                                                                             \
                                                                                                    \
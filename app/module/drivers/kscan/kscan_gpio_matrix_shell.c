@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_kscan_gpio_matrix
+
+#include <zephyr/device.h>
+#include <zephyr/shell/shell.h>
+
+#include <zmk/kscan_gpio_matrix.h>
+
+#define MATRIX_DEVICE(n) DEVICE_DT_INST_GET(n),
+
+static const struct device *const matrices[] = {DT_INST_FOREACH_STATUS_OKAY(MATRIX_DEVICE)};
+
+static int cmd_kscan_stats(const struct shell *sh, size_t argc, char **argv) {
+    for (size_t i = 0; i < ARRAY_SIZE(matrices); i++) {
+        struct zmk_kscan_gpio_matrix_stats stats;
+        int err = zmk_kscan_gpio_matrix_get_stats(matrices[i], &stats);
+        if (err < 0) {
+            shell_error(sh, "Failed to get stats for %s (%d)", matrices[i]->name, err);
+            return err;
+        }
+
+        shell_print(sh, "%s:", matrices[i]->name);
+        shell_print(sh, "  scans:         %u (%u Hz)", stats.scans, stats.scan_rate_hz);
+        shell_print(sh, "  press latency: avg %u ms, max %u ms over %u presses",
+                    stats.press_latency_avg_ms, stats.press_latency_max_ms, stats.presses);
+    }
+
+    return 0;
+}
+
+static int cmd_kscan_stats_reset(const struct shell *sh, size_t argc, char **argv) {
+    for (size_t i = 0; i < ARRAY_SIZE(matrices); i++) {
+        int err = zmk_kscan_gpio_matrix_reset_stats(matrices[i]);
+        if (err < 0) {
+            shell_error(sh, "Failed to reset stats for %s (%d)", matrices[i]->name, err);
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_kscan_stats,
+                               SHELL_CMD(reset, NULL, "Reset matrix scan statistics",
+                                         cmd_kscan_stats_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_kscan,
+                               SHELL_CMD(stats, &sub_kscan_stats, "Show matrix scan statistics",
+                                         cmd_kscan_stats),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(kscan, &sub_kscan, "Key scan commands", NULL);
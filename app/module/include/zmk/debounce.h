@@ -7,6 +7,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <zephyr/sys/util.h>
 
@@ -54,3 +55,90 @@ bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state);
  * debounce_update.
  */
 bool zmk_debounce_get_changed(const struct zmk_debounce_state *state);
+
+/** Number of 32-bit words in a bitmap with one bit for each of n switches. */
+#define ZMK_DEBOUNCE_BITMAP_WORDS(n) DIV_ROUND_UP(n, 32)
+
+/**
+ * Debounce state for a group of switches that are scanned together, e.g. all keys of one kscan
+ * instance. Besides the per-switch states, it keeps packed bitmaps with one bit per switch so
+ * that switches which are idle can be skipped a whole word at a time.
+ */
+struct zmk_debounce_group {
+    /** Number of switches in the group. */
+    size_t len;
+    /** Per-switch debounce states. */
+    struct zmk_debounce_state *states;
+    /** Raw state of each switch, set with zmk_debounce_group_set_raw() before each update. */
+    uint32_t *raw;
+    /** Switches latched as pressed. */
+    uint32_t *pressed;
+    /** Switches whose debounce counter is running. */
+    uint32_t *pending;
+    /** Switches whose pressed state changed in the last update. */
+    uint32_t *changed;
+};
+
+/**
+ * Define a static debounce group for n switches.
+ */
+#define ZMK_DEBOUNCE_GROUP_DEFINE(name, n)                                                         \
+    static struct zmk_debounce_state _CONCAT(name, _states)[n];                                    \
+    static uint32_t _CONCAT(name, _bitmaps)[4][ZMK_DEBOUNCE_BITMAP_WORDS(n)];                      \
+    static struct zmk_debounce_group name = {                                                      \
+        .len = (n),                                                                                \
+        .states = _CONCAT(name, _states),                                                          \
+        .raw = _CONCAT(name, _bitmaps)[0],                                                         \
+        .pressed = _CONCAT(name, _bitmaps)[1],                                                     \
+        .pending = _CONCAT(name, _bitmaps)[2],                                                     \
+        .changed = _CONCAT(name, _bitmaps)[3],                                                     \
+    }
+
+/**
+ * Set the raw state of one switch for the next call to zmk_debounce_group_update().
+ */
+static inline void zmk_debounce_group_set_raw(struct zmk_debounce_group *group, const size_t index,
+                                              const bool active) {
+    WRITE_BIT(group->raw[index / 32], index % 32, active);
+}
+
+/**
+ * Debounces every switch in a group from the raw states set with zmk_debounce_group_set_raw().
+ *
+ * Only switches whose raw state differs from their latched state, or which are still being
+ * debounced, are updated. Use the group's changed bitmap rather than zmk_debounce_get_changed()
+ * on the individual states afterwards, since skipped switches keep their old changed flag.
+ *
+ * @param group The group of switches to debounce.
+ * @param elapsed_ms Time elapsed since the previous update in milliseconds.
+ * @param config Debounce settings.
+ */
+void zmk_debounce_group_update(struct zmk_debounce_group *group, const int elapsed_ms,
+                               const struct zmk_debounce_config *config);
+
+/**
+ * @returns whether any switch in the group is either latched as pressed or potentially pressed,
+ * see zmk_debounce_is_active().
+ */
+bool zmk_debounce_group_is_active(const struct zmk_debounce_group *group);
+
+/**
+ * @returns whether the switch at index is latched as pressed.
+ */
+static inline bool zmk_debounce_group_is_pressed(const struct zmk_debounce_group *group,
+                                                 const size_t index) {
+    return (group->pressed[index / 32] & BIT(index % 32)) != 0;
+}
+
+/**
+ * @returns the index of the first switch at or after start whose pressed state changed in the
+ * last update, or group->len if there is none.
+ */
+size_t zmk_debounce_group_next_changed(const struct zmk_debounce_group *group, size_t start);
+
+/**
+ * Iterate over the index of every switch whose pressed state changed in the last update.
+ */
+#define ZMK_DEBOUNCE_GROUP_FOREACH_CHANGED(group, index)                                           \
+    for (size_t index = zmk_debounce_group_next_changed(group, 0); index < (group)->len;           \
+         index = zmk_debounce_group_next_changed(group, index + 1))
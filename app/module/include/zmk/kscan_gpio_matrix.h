@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+struct zmk_kscan_gpio_matrix_stats {
+    /** Number of matrix scans since the stats were last reset. */
+    uint32_t scans;
+    /** Average number of scans per second since the stats were last reset. */
+    uint32_t scan_rate_hz;
+    /** Number of key presses reported since the stats were last reset. */
+    uint32_t presses;
+    /**
+     * Average time in milliseconds from the last scan that saw a key released (or the interrupt
+     * that woke the scanner) to its press being reported. This is an upper bound on the latency
+     * added by scanning and debouncing.
+     */
+    uint32_t press_latency_avg_ms;
+    /** Maximum press latency in milliseconds, see press_latency_avg_ms. */
+    uint32_t press_latency_max_ms;
+};
+
+/**
+ * Tell a matrix scanner whether the keyboard is active. While inactive, the scanner skips any
+ * remaining burst or decay period after keys are released and immediately returns to its idle
+ * poll period or interrupts.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if adaptive scanning is not enabled.
+ */
+int zmk_kscan_gpio_matrix_set_active(const struct device *dev, bool active);
+
+/**
+ * Get the scan statistics of a matrix scanner.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if scan statistics are not enabled.
+ */
+int zmk_kscan_gpio_matrix_get_stats(const struct device *dev,
+                                    struct zmk_kscan_gpio_matrix_stats *stats);
+
+/**
+ * Reset the scan statistics of a matrix scanner.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if scan statistics are not enabled.
+ */
+int zmk_kscan_gpio_matrix_reset_stats(const struct device *dev);
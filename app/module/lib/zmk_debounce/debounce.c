@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <zephyr/sys/math_extras.h>
+
 #include <zmk/debounce.h>
 
 static uint32_t get_threshold(const struct zmk_debounce_state *state,
@@ -59,4 +61,52 @@ bool zmk_debounce_is_active(const struct zmk_debounce_state *state) {
 
 bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state) { return state->pressed; }
 
-bool zmk_debounce_get_changed(const struct zmk_debounce_state *state) { return state->changed; }
\ No newline at end of file
+bool zmk_debounce_get_changed(const struct zmk_debounce_state *state) { return state->changed; }
+
+void zmk_debounce_group_update(struct zmk_debounce_group *group, const int elapsed_ms,
+                               const struct zmk_debounce_config *config) {
+    for (size_t w = 0; w < ZMK_DEBOUNCE_BITMAP_WORDS(group->len); w++) {
+        // A switch can only change if its raw state differs from the latched state or its
+        // counter is still running. Everything else would just decrement a zero counter.
+        uint32_t work = (group->raw[w] ^ group->pressed[w]) | group->pending[w];
+
+        group->changed[w] = 0;
+
+        while (work) {
+            const unsigned int bit = u32_count_trailing_zeros(work);
+            struct zmk_debounce_state *state = &group->states[w * 32 + bit];
+
+            work &= work - 1;
+
+            zmk_debounce_update(state, (group->raw[w] & BIT(bit)) != 0, elapsed_ms, config);
+
+            WRITE_BIT(group->pressed[w], bit, state->pressed);
+            WRITE_BIT(group->pending[w], bit, state->counter > 0);
+            WRITE_BIT(group->changed[w], bit, state->changed);
+        }
+    }
+}
+
+bool zmk_debounce_group_is_active(const struct zmk_debounce_group *group) {
+    for (size_t w = 0; w < ZMK_DEBOUNCE_BITMAP_WORDS(group->len); w++) {
+        if (group->pressed[w] | group->pending[w]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t zmk_debounce_group_next_changed(const struct zmk_debounce_group *group, size_t start) {
+    for (size_t w = start / 32; w < ZMK_DEBOUNCE_BITMAP_WORDS(group->len); w++) {
+        uint32_t word = group->changed[w];
+
+        if (w == start / 32) {
+            word &= ~BIT_MASK(start % 32);
+        }
+
+        if (word) {
+            return w * 32 + u32_count_trailing_zeros(word);
+        }
+    }
+    return group->len;
+}
@@ -0,0 +1,126 @@
+#!/bin/sh
+
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+
+##
+# Optional environment variables, paths can be absolute or relative to $(pwd):
+#  ZMK_SRC_DIR:                 Path to zmk/app (default is ./)
+#  ZMK_BUILD_DIR:               Path to build directory (default is $ZMK_SRC_DIR/build)
+#  ZMK_EXTRA_MODULES:           Path to at most one module (in addition to any in west.yml)
+#  ZMK_BENCHMARKS_VERBOSE:      Be more verbose
+#  ZMK_BENCHMARKS_UPDATE:       Record baseline files from the new results, required if missing
+#  ZMK_BENCHMARKS_BASELINE_DIR: Directory to read and record baselines in, laid out like
+#                               benchmarks/ (default is next to each benchmark case)
+#  ZMK_BENCHMARKS_TOLERANCE:    Allowed regression in percent before failing (default is 25)
+#  J:                           Number of parallel jobs (default is 1, to keep timings stable)
+
+if [ -z "$1" ]; then
+    echo "Usage: ./run-benchmark.sh <path to benchmark case>"
+    exit 1
+fi
+
+path="$1"
+if [ $path = "all" ]; then
+    path="${ZMK_SRC_DIR-.}/benchmarks"
+fi
+
+ZMK_BUILD_DIR=${ZMK_BUILD_DIR:-${ZMK_SRC_DIR:-.}/build}
+mkdir -p ${ZMK_BUILD_DIR}/benchmarks
+
+cases=$(find $path -name native_posix_64.keymap -exec dirname \{\} \;)
+num_cases=$(echo "$cases" | wc -l)
+if [ $num_cases -gt 1 ] || [ "$cases" != "$path" ]; then
+    echo "" >${ZMK_BUILD_DIR}/benchmarks/pass-fail.log
+    echo "$cases" | xargs -L 1 -P ${J:-1} ${0}
+    err=$?
+    sort -k2 ${ZMK_BUILD_DIR}/benchmarks/pass-fail.log
+    exit $err
+fi
+
+benchmark=$(realpath $path | sed -n -e "s|.*/benchmarks/||p")
+echo "Running $benchmark:"
+
+build_cmd="west build ${ZMK_SRC_DIR:+-s $ZMK_SRC_DIR} -d ${ZMK_BUILD_DIR}/benchmarks/$benchmark \
+    -b native_posix_64 -p -- -DZMK_CONFIG="$(realpath $path)" \
+    ${ZMK_EXTRA_MODULES:+-DZMK_EXTRA_MODULES="$(realpath ${ZMK_EXTRA_MODULES})"}"
+
+if [ -z ${ZMK_BENCHMARKS_VERBOSE} ]; then
+    $build_cmd >/dev/null 2>&1
+else
+    $build_cmd
+fi
+
+if [ $? -gt 0 ]; then
+    echo "FAILED: $benchmark did not build" | tee -a ${ZMK_BUILD_DIR}/benchmarks/pass-fail.log
+    exit 1
+fi
+
+results=${ZMK_BUILD_DIR}/benchmarks/$benchmark/results.jsonl
+
+# Run without slowing down to real time, so only the time spent processing events is measured.
+${ZMK_BUILD_DIR}/benchmarks/$benchmark/zephyr/zmk.exe -no-rt |
+    sed -n -e "s/.*zmk_benchmark: //p" >$results
+
+if [ -n "${ZMK_BENCHMARKS_VERBOSE}" ]; then
+    cat $results
+fi
+
+if [ -n "${ZMK_BENCHMARKS_BASELINE_DIR}" ]; then
+    baseline=${ZMK_BENCHMARKS_BASELINE_DIR}/$benchmark/baseline.jsonl
+    mkdir -p $(dirname $baseline)
+else
+    baseline=$path/baseline.jsonl
+fi
+
+summary_value() {
+    grep '"events"' $1 | sed -n -e "s/.*\"$2\":\([0-9]*\).*/\1/p"
+}
+
+if [ -n "${ZMK_BENCHMARKS_UPDATE}" ]; then
+    echo "Recording baseline for $benchmark"
+    cp $results $baseline
+    echo "PASS: $benchmark (baseline recorded)" | tee -a ${ZMK_BUILD_DIR}/benchmarks/pass-fail.log
+    exit 0
+fi
+
+# A missing baseline must not pass, or a deleted one would hide any regression.
+if [ ! -f $baseline ]; then
+    echo "$benchmark: no baseline.jsonl, record one with ZMK_BENCHMARKS_UPDATE=1 and check it in"
+    echo "FAILED: $benchmark (no baseline)" | tee -a ${ZMK_BUILD_DIR}/benchmarks/pass-fail.log
+    exit 1
+fi
+
+tolerance=${ZMK_BENCHMARKS_TOLERANCE:-25}
+failed=0
+
+# Dropped kscan events never reach the endpoint, so the latencies would only cover the rest.
+kscan_dropped=$(sed -n -e 's/.*"kscan_queue_dropped":\([0-9]*\).*/\1/p' $results)
+if [ "${kscan_dropped:-0}" -gt 0 ]; then
+    echo "$benchmark: dropped $kscan_dropped kscan events, bump CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE"
+    failed=1
+fi
+
+for metric in p50_ns p99_ns; do
+    base=$(summary_value $baseline $metric)
+    new=$(summary_value $results $metric)
+    if [ $((new * 100)) -gt $((base * (100 + tolerance))) ]; then
+        echo "$benchmark: $metric regressed from $base to $new"
+        failed=1
+    fi
+done
+
+base=$(summary_value $baseline events_per_sec)
+new=$(summary_value $results events_per_sec)
+if [ $((new * (100 + tolerance))) -lt $((base * 100)) ]; then
+    echo "$benchmark: events_per_sec regressed from $base to $new"
+    failed=1
+fi
+
+if [ $failed -gt 0 ]; then
+    echo "FAILED: $benchmark" | tee -a ${ZMK_BUILD_DIR}/benchmarks/pass-fail.log
+    exit 1
+fi
+
+echo "PASS: $benchmark" | tee -a ${ZMK_BUILD_DIR}/benchmarks/pass-fail.log
+exit 0
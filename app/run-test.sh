@@ -38,8 +38,22 @@ fi
 testcase=$(realpath $path | sed -n -e "s|.*/tests/||p")
 echo "Running $testcase:"
 
+# Testcases with a peripheral.overlay run a second, peripheral build of the same config, with the
+# split UARTs of both halves connected by a pty pair.
+peripheral_dir=""
+central_overlay=""
+if [ -f $path/peripheral.overlay ]; then
+    peripheral_dir=${ZMK_BUILD_DIR}/tests/${testcase}_peripheral
+    pty_dir=$(realpath ${ZMK_BUILD_DIR})/tests/${testcase}_pty
+    mkdir -p $pty_dir
+    for role in central peripheral; do
+        echo "&split_uart { serial-port = \"$pty_dir/$role\"; };" >$pty_dir/$role.overlay
+    done
+    central_overlay="-DEXTRA_DTC_OVERLAY_FILE=$pty_dir/central.overlay"
+fi
+
 build_cmd="west build ${ZMK_SRC_DIR:+-s $ZMK_SRC_DIR} -d ${ZMK_BUILD_DIR}/tests/$testcase \
-    -b native_posix_64 -p -- -DCONFIG_ASSERT=y -DZMK_CONFIG="$(realpath $path)" \
+    -b native_posix_64 -p -- -DCONFIG_ASSERT=y -DZMK_CONFIG="$(realpath $path)" $central_overlay \
     ${ZMK_EXTRA_MODULES:+-DZMK_EXTRA_MODULES="$(realpath ${ZMK_EXTRA_MODULES})"}"
 
 if [ -z ${ZMK_TESTS_VERBOSE} ]; then
@@ -49,17 +63,58 @@ else
     echo "ZMK_BUILD_DIR: $ZMK_BUILD_DIR"
     $build_cmd
 fi
+build_err=$?
 
-if [ $? -gt 0 ]; then
+if [ $build_err -eq 0 ] && [ -n "$peripheral_dir" ]; then
+    peripheral_overlays="$(realpath $path/peripheral.overlay);$pty_dir/peripheral.overlay"
+    peripheral_build_cmd="west build ${ZMK_SRC_DIR:+-s $ZMK_SRC_DIR} -d $peripheral_dir \
+        -b native_posix_64 -p -- -DCONFIG_ASSERT=y -DZMK_CONFIG="$(realpath $path)" \
+        -DCONFIG_ZMK_SPLIT_ROLE_CENTRAL=n -DEXTRA_DTC_OVERLAY_FILE="$peripheral_overlays" \
+        ${ZMK_EXTRA_MODULES:+-DZMK_EXTRA_MODULES="$(realpath ${ZMK_EXTRA_MODULES})"}"
+
+    if [ -z ${ZMK_TESTS_VERBOSE} ]; then
+        $peripheral_build_cmd >/dev/null 2>&1
+    else
+        $peripheral_build_cmd
+    fi
+    build_err=$?
+fi
+
+if [ $build_err -gt 0 ]; then
     echo "FAILED: $testcase did not build" | tee -a ${ZMK_BUILD_DIR}/tests/pass-fail.log
     exit 1
 fi
 
+if [ -n "$peripheral_dir" ]; then
+    rm -f $pty_dir/central $pty_dir/peripheral
+    socat pty,raw,echo=0,link=$pty_dir/central pty,raw,echo=0,link=$pty_dir/peripheral &
+    socat_pid=$!
+    while [ ! -e $pty_dir/central ] || [ ! -e $pty_dir/peripheral ]; do
+        sleep 0.1
+    done
+
+    $peripheral_dir/zephyr/zmk.exe >$peripheral_dir/keycode_events_full.log 2>&1 &
+    peripheral_pid=$!
+
+    # The central's events are timed from its own boot, so only start it once the peripheral is
+    # up and sending. It then sees the link come up before any of its scripted events.
+    tries=0
+    while [ ! -s $peripheral_dir/keycode_events_full.log ] && [ $tries -lt 50 ]; do
+        sleep 0.1
+        tries=$((tries + 1))
+    done
+fi
+
 ${ZMK_BUILD_DIR}/tests/$testcase/zephyr/zmk.exe |
     sed -e "s/.*> //" |
     tee ${ZMK_BUILD_DIR}/tests/$testcase/keycode_events_full.log |
     sed -n -f $path/events.patterns >${ZMK_BUILD_DIR}/tests/$testcase/keycode_events.log
 
+if [ -n "$peripheral_dir" ]; then
+    kill $peripheral_pid $socat_pid 2>/dev/null
+    wait $peripheral_pid $socat_pid 2>/dev/null
+fi
+
 diff -auZ $path/keycode_events.snapshot ${ZMK_BUILD_DIR}/tests/$testcase/keycode_events.log
 if [ $? -gt 0 ]; then
     if [ -f $path/pending ]; then
@@ -18,6 +18,10 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/sensor_event.h>
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) && IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+#include <zmk/events/keycode_state_changed.h>
+#endif
+
 #include <zmk/pm.h>
 
 #include <zmk/activity.h>
@@ -110,6 +114,11 @@ ZMK_LISTENER(activity, activity_event_listener);
 ZMK_SUBSCRIPTION(activity, zmk_position_state_changed);
 ZMK_SUBSCRIPTION(activity, zmk_sensor_event);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) && IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+// Keys resolved by peripherals arrive as keycodes, without a position event.
+ZMK_SUBSCRIPTION(activity, zmk_keycode_state_changed);
+#endif
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 
 static void note_activity_work_cb(struct k_work *_work) { note_activity(); }
@@ -17,9 +17,8 @@
 
 #endif
 
-#include <zmk/ble.h>
-#if ZMK_BLE_IS_CENTRAL
-#include <zmk/split/bluetooth/central.h>
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#include <zmk/split/central.h>
 #endif
 
 #include <drivers/behavior.h>
@@ -56,6 +55,28 @@ const struct device *z_impl_behavior_get_binding(const char *name) {
     return NULL;
 }
 
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding) {
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+    if (binding->behavior_dev_cache && z_device_is_ready(binding->behavior_dev_cache)) {
+        return binding->behavior_dev_cache;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+
+    return zmk_behavior_get_binding(binding->behavior_dev);
+}
+
+int zmk_behavior_resolve_binding_device(struct zmk_behavior_binding *binding) {
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+    binding->behavior_dev_cache = zmk_behavior_get_binding(binding->behavior_dev);
+
+    if (!binding->behavior_dev_cache) {
+        return -ENODEV;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+
+    return 0;
+}
+
 static int invoke_locally(struct zmk_behavior_binding *binding,
                           struct zmk_behavior_binding_event event, bool pressed) {
     if (pressed) {
@@ -71,7 +92,7 @@ int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
     // relative to absolute before being invoked
     struct zmk_behavior_binding binding = *src_binding;
 
-    const struct device *behavior = zmk_behavior_get_binding(binding.behavior_dev);
+    const struct device *behavior = zmk_behavior_get_binding_device(&binding);
 
     if (!behavior) {
         LOG_WRN("No behavior assigned to %d on layer %d", event.position, event.layer);
@@ -95,19 +116,21 @@ int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
     case BEHAVIOR_LOCALITY_CENTRAL:
         return invoke_locally(&binding, event, pressed);
     case BEHAVIOR_LOCALITY_EVENT_SOURCE:
-#if ZMK_BLE_IS_CENTRAL // source is a member of event because CONFIG_ZMK_SPLIT is enabled
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) // source is a member of event with CONFIG_ZMK_SPLIT
         if (event.source == ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL) {
             return invoke_locally(&binding, event, pressed);
         } else {
-            return zmk_split_bt_invoke_behavior(event.source, &binding, event, pressed);
+            return zmk_split_central_invoke_behavior(event.source, &binding, event, pressed);
         }
 #else
         return invoke_locally(&binding, event, pressed);
 #endif
     case BEHAVIOR_LOCALITY_GLOBAL:
-#if ZMK_BLE_IS_CENTRAL
-        for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
-            zmk_split_bt_invoke_behavior(i, &binding, event, pressed);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+        uint8_t sources[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+        const int count = zmk_split_central_get_available_source_ids(sources);
+        for (int i = 0; i < count; i++) {
+            zmk_split_central_invoke_behavior(sources[i], &binding, event, pressed);
         }
 #endif
         return invoke_locally(&binding, event, pressed);
@@ -240,7 +263,7 @@ int zmk_behavior_check_params_match_metadata(const struct behavior_parameter_met
 
 int zmk_behavior_validate_binding(const struct zmk_behavior_binding *binding) {
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
-    const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior = zmk_behavior_get_binding_device(binding);
 
     if (!behavior) {
         return -ENODEV;
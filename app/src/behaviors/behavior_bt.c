@@ -43,6 +43,23 @@ static const struct behavior_parameter_value_metadata no_arg_values[] = {
         .type = BEHAVIOR_PARAMETER_VALUE_TYPE_VALUE,
         .value = BT_CLR_CMD,
     },
+#if IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN)
+    {
+        .display_name = "Toggle Mirroring",
+        .type = BEHAVIOR_PARAMETER_VALUE_TYPE_VALUE,
+        .value = BT_MIRROR_TOG_CMD,
+    },
+    {
+        .display_name = "Enable Mirroring",
+        .type = BEHAVIOR_PARAMETER_VALUE_TYPE_VALUE,
+        .value = BT_MIRROR_ON_CMD,
+    },
+    {
+        .display_name = "Disable Mirroring",
+        .type = BEHAVIOR_PARAMETER_VALUE_TYPE_VALUE,
+        .value = BT_MIRROR_OFF_CMD,
+    },
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN)
 };
 
 static const struct behavior_parameter_metadata_set no_args_set = {
@@ -105,6 +122,12 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
         return 0;
     case BT_DISC_CMD:
         return zmk_ble_prof_disconnect(binding->param2);
+    case BT_MIRROR_ON_CMD:
+        return zmk_ble_set_mirror(true);
+    case BT_MIRROR_OFF_CMD:
+        return zmk_ble_set_mirror(false);
+    case BT_MIRROR_TOG_CMD:
+        return zmk_ble_toggle_mirror();
     default:
         LOG_ERR("Unknown BT command: %d", binding->param1);
     }
@@ -17,7 +17,7 @@
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/keycode_state_changed.h>
-#include <zmk/behavior.h>
+#include <zmk/captured_events.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -50,6 +50,7 @@ enum decision_moment {
     HT_OTHER_KEY_UP,
     HT_TIMER_EVENT,
     HT_QUICK_TAP,
+    HT_CAPTURE_OVERFLOW,
 };
 
 struct behavior_hold_tap_config {
@@ -99,24 +100,7 @@ struct active_hold_tap {
 struct active_hold_tap *undecided_hold_tap = NULL;
 struct active_hold_tap active_hold_taps[ZMK_BHV_HOLD_TAP_MAX_HELD] = {};
 // We capture most position_state_changed events and some modifiers_state_changed events.
-
-enum captured_event_tag {
-    ET_NONE,
-    ET_POS_CHANGED,
-    ET_CODE_CHANGED,
-};
-
-union captured_event_data {
-    struct zmk_position_state_changed_event position;
-    struct zmk_keycode_state_changed_event keycode;
-};
-
-struct captured_event {
-    enum captured_event_tag tag;
-    union captured_event_data data;
-};
-
-struct captured_event captured_events[ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS] = {};
+ZMK_CAPTURED_EVENTS_DEFINE(captured_events, ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS);
 
 // Keep track of which key was tapped most recently for the standard, if it is a hold-tap
 // a position, will be given, if not it will just be INT32_MIN
@@ -150,97 +134,49 @@ static bool is_quick_tap(struct active_hold_tap *hold_tap) {
     }
 }
 
-static int capture_event(struct captured_event *data) {
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        if (captured_events[i].tag == ET_NONE) {
-            captured_events[i] = *data;
-            return 0;
-        }
-    }
-    return -ENOMEM;
-}
-
-static bool have_captured_keydown_event(uint32_t position) {
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        struct captured_event *ev = &captured_events[i];
-        if (ev->tag == ET_NONE) {
-            return false;
-        }
+const struct zmk_listener zmk_listener_behavior_hold_tap;
 
-        if (ev->tag != ET_POS_CHANGED) {
-            continue;
-        }
+static void release_captured_event(struct zmk_captured_event *captured_event, void *user_data) {
+    if (undecided_hold_tap != NULL) {
+        k_msleep(10);
+    }
 
-        if (ev->data.position.data.position == position && ev->data.position.data.state) {
-            return true;
-        }
+    switch (captured_event->tag) {
+    case ZMK_CAPTURED_EVENT_KEYCODE:
+        LOG_DBG("Releasing mods changed event 0x%02X %s",
+                captured_event->data.keycode.data.keycode,
+                (captured_event->data.keycode.data.state ? "pressed" : "released"));
+        ZMK_EVENT_RAISE_AT(captured_event->data.keycode, behavior_hold_tap);
+        break;
+    case ZMK_CAPTURED_EVENT_POSITION:
+        LOG_DBG("Releasing key position event for position %d %s",
+                captured_event->data.position.data.position,
+                (captured_event->data.position.data.state ? "pressed" : "released"));
+        ZMK_EVENT_RAISE_AT(captured_event->data.position, behavior_hold_tap);
+        break;
+    default:
+        LOG_ERR("Unhandled captured event type");
+        break;
     }
-    return false;
 }
 
-const struct zmk_listener zmk_listener_behavior_hold_tap;
-
 static void release_captured_events() {
     if (undecided_hold_tap != NULL) {
         return;
     }
 
-    // We use a trick to prevent copying the captured_events array.
-    //
-    // Events for different mod-tap instances are separated by a NULL pointer.
+    // Captured events are raised in place from the ring, oldest first.
     //
-    // The first event popped will never be caught by the next active hold-tap
-    // because to start capturing a mod-tap-key-down event must first completely
-    // go through the events queue.
+    // A released event may start a new undecided hold-tap, which then captures the events
+    // released after it. Those are appended behind the events still being released, so the new
+    // hold-tap only ever releases its own events once it is decided:
     //
-    // Example of this release process;
-    // [mt2_down, k1_down, k1_up, mt2_up, null, ...]
-    //  ^
-    // mt2_down position event isn't captured because no hold-tap is active.
-    // mt2_down behavior event is handled, now we have an undecided hold-tap
-    // [null, k1_down, k1_up, mt2_up, null, ...]
-    //        ^
-    // k1_down  is captured by the mt2 mod-tap
-    // !note that searches for find_captured_keydown_event by the mt2 behavior will stop at the
-    // first null encountered [mt1_down, null, k1_up, mt2_up, null, ...]
-    //                  ^
-    // k1_up event is captured by the new hold-tap:
-    // [k1_down, k1_up, null, mt2_up, null, ...]
-    //                        ^
-    // mt2_up event is not captured but causes release of mt2 behavior
-    // [k1_down, k1_up, null, null, null, ...]
-    // now mt2 will start releasing it's own captured positions.
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        struct captured_event *captured_event = &captured_events[i];
-        enum captured_event_tag tag = captured_event->tag;
-
-        if (tag == ET_NONE) {
-            return;
-        }
-
-        captured_events[i].tag = ET_NONE;
-        if (undecided_hold_tap != NULL) {
-            k_msleep(10);
-        }
-
-        switch (tag) {
-        case ET_CODE_CHANGED:
-            LOG_DBG("Releasing mods changed event 0x%02X %s",
-                    captured_event->data.keycode.data.keycode,
-                    (captured_event->data.keycode.data.state ? "pressed" : "released"));
-            ZMK_EVENT_RAISE_AT(captured_event->data.keycode, behavior_hold_tap);
-            break;
-        case ET_POS_CHANGED:
-            LOG_DBG("Releasing key position event for position %d %s",
-                    captured_event->data.position.data.position,
-                    (captured_event->data.position.data.state ? "pressed" : "released"));
-            ZMK_EVENT_RAISE_AT(captured_event->data.position, behavior_hold_tap);
-            break;
-        default:
-            LOG_ERR("Unhandled captured event type");
-            break;
-        }
-    }
+    // [mt2_down, k1_down, k1_up, mt2_up]
+    // mt2_down isn't captured because no hold-tap is active, it starts a new undecided hold-tap.
+    // k1_down and k1_up are captured again by mt2 and appended behind mt2_up, which is still
+    // waiting to be released.
+    // mt2_up is not captured but decides mt2, which then releases only [k1_down, k1_up].
+    zmk_captured_events_replay(&captured_events, release_captured_event, NULL);
 }
 
 static struct active_hold_tap *find_hold_tap(uint32_t position) {
@@ -292,6 +228,7 @@ static void decide_balanced(struct active_hold_tap *hold_tap, enum decision_mome
         hold_tap->status = STATUS_HOLD_TIMER;
         return;
     case HT_QUICK_TAP:
+    case HT_CAPTURE_OVERFLOW:
         hold_tap->status = STATUS_TAP;
         return;
     default:
@@ -308,6 +245,7 @@ static void decide_tap_preferred(struct active_hold_tap *hold_tap, enum decision
         hold_tap->status = STATUS_HOLD_TIMER;
         return;
     case HT_QUICK_TAP:
+    case HT_CAPTURE_OVERFLOW:
         hold_tap->status = STATUS_TAP;
         return;
     default:
@@ -328,6 +266,7 @@ static void decide_tap_unless_interrupted(struct active_hold_tap *hold_tap,
         hold_tap->status = STATUS_TAP;
         return;
     case HT_QUICK_TAP:
+    case HT_CAPTURE_OVERFLOW:
         hold_tap->status = STATUS_TAP;
         return;
     default:
@@ -347,6 +286,7 @@ static void decide_hold_preferred(struct active_hold_tap *hold_tap, enum decisio
         hold_tap->status = STATUS_HOLD_TIMER;
         return;
     case HT_QUICK_TAP:
+    case HT_CAPTURE_OVERFLOW:
         hold_tap->status = STATUS_TAP;
         return;
     default:
@@ -396,6 +336,8 @@ static inline const char *decision_moment_str(enum decision_moment decision_mome
         return "quick-tap";
     case HT_TIMER_EVENT:
         return "timer";
+    case HT_CAPTURE_OVERFLOW:
+        return "capture-overflow";
     default:
         return "UNKNOWN STATUS";
     }
@@ -766,7 +708,7 @@ static int position_state_changed_listener(const zmk_event_t *eh) {
         return ZMK_EV_EVENT_BUBBLE;
     }
 
-    if (!ev->state && !have_captured_keydown_event(ev->position)) {
+    if (!ev->state && !zmk_captured_events_has_keydown(&captured_events, ev->position)) {
         // no keydown event has been captured, let it bubble.
         // we'll catch modifiers later in modifier_state_changed_listener
         LOG_DBG("%d bubbling %d %s event", undecided_hold_tap->position, ev->position,
@@ -774,13 +716,21 @@ static int position_state_changed_listener(const zmk_event_t *eh) {
         return ZMK_EV_EVENT_BUBBLE;
     }
 
+    if (zmk_captured_events_capture_position(&captured_events, ev) < 0) {
+        // Rather than dropping the event, decide now so that everything captured so far is
+        // released ahead of it, then handle it again. The flavor decides as if the event had been
+        // captured, and if that leaves the hold-tap undecided it is a tap: a timer decision would
+        // turn a key typed before the tapping term into a hold.
+        LOG_WRN("%d unable to capture %d %s event, forcing a decision",
+                undecided_hold_tap->position, ev->position, ev->state ? "down" : "up");
+        struct active_hold_tap *hold_tap = undecided_hold_tap;
+        decide_hold_tap(hold_tap, ev->state ? HT_OTHER_KEY_DOWN : HT_OTHER_KEY_UP);
+        decide_hold_tap(hold_tap, HT_CAPTURE_OVERFLOW);
+        return position_state_changed_listener(eh);
+    }
+
     LOG_DBG("%d capturing %d %s event", undecided_hold_tap->position, ev->position,
             ev->state ? "down" : "up");
-    struct captured_event capture = {
-        .tag = ET_POS_CHANGED,
-        .data = {.position = copy_raised_zmk_position_state_changed(ev)},
-    };
-    capture_event(&capture);
     decide_hold_tap(undecided_hold_tap, ev->state ? HT_OTHER_KEY_DOWN : HT_OTHER_KEY_UP);
     return ZMK_EV_EVENT_CAPTURED;
 }
@@ -811,11 +761,16 @@ static int keycode_state_changed_listener(const zmk_event_t *eh) {
 
     // only key-up events will bubble through position_state_changed_listener
     // if a undecided_hold_tap is active.
+    if (zmk_captured_events_capture_keycode(&captured_events, ev) < 0) {
+        // No flavor decides on modifiers, so this is a tap, see position_state_changed_listener.
+        LOG_WRN("%d unable to capture 0x%02X %s event, forcing a decision",
+                undecided_hold_tap->position, ev->keycode, ev->state ? "down" : "up");
+        decide_hold_tap(undecided_hold_tap, HT_CAPTURE_OVERFLOW);
+        return keycode_state_changed_listener(eh);
+    }
+
     LOG_DBG("%d capturing 0x%02X %s event", undecided_hold_tap->position, ev->keycode,
             ev->state ? "down" : "up");
-    struct captured_event capture = {
-        .tag = ET_CODE_CHANGED, .data = {.keycode = copy_raised_zmk_keycode_state_changed(ev)}};
-    capture_event(&capture);
     return ZMK_EV_EVENT_CAPTURED;
 }
 
@@ -42,6 +42,18 @@ static const struct behavior_parameter_value_metadata std_values[] = {
         .type = BEHAVIOR_PARAMETER_VALUE_TYPE_VALUE,
     },
 #endif // IS_ENABLED(CONFIG_ZMK_BLE)
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    {
+        .value = OUT_NKRO,
+        .display_name = "NKRO Keyboard Report",
+        .type = BEHAVIOR_PARAMETER_VALUE_TYPE_VALUE,
+    },
+    {
+        .value = OUT_HKRO,
+        .display_name = "HKRO Keyboard Report",
+        .type = BEHAVIOR_PARAMETER_VALUE_TYPE_VALUE,
+    },
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
 };
 
 static const struct behavior_parameter_metadata_set std_set = {
@@ -65,6 +77,12 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
         return zmk_endpoints_select_transport(ZMK_TRANSPORT_USB);
     case OUT_BLE:
         return zmk_endpoints_select_transport(ZMK_TRANSPORT_BLE);
+    case OUT_NKRO:
+        return zmk_endpoints_set_keyboard_report_type(zmk_endpoints_selected(),
+                                                      ZMK_HID_KEYBOARD_REPORT_TYPE_NKRO);
+    case OUT_HKRO:
+        return zmk_endpoints_set_keyboard_report_type(zmk_endpoints_selected(),
+                                                      ZMK_HID_KEYBOARD_REPORT_TYPE_HKRO);
     default:
         LOG_ERR("Unknown output command: %d", binding->param1);
     }
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#if IS_ENABLED(CONFIG_ARCH_POSIX)
+#include <stdlib.h>
+#include <time.h>
+#endif
+
+#include <zmk/benchmark.h>
+#include <zmk/physical_layouts.h>
+
+struct stage_stats {
+    uint32_t count;
+    uint64_t total_ns;
+    uint32_t max_ns;
+};
+
+static const char *stage_names[ZMK_BENCHMARK_STAGE_COUNT] = {
+    [ZMK_BENCHMARK_STAGE_KSCAN] = "kscan",       [ZMK_BENCHMARK_STAGE_POSITION] = "position",
+    [ZMK_BENCHMARK_STAGE_KEYMAP] = "keymap",     [ZMK_BENCHMARK_STAGE_HID] = "hid",
+    [ZMK_BENCHMARK_STAGE_ENDPOINT] = "endpoint",
+};
+
+static struct stage_stats stage_stats[ZMK_BENCHMARK_STAGE_COUNT];
+
+static uint32_t latencies_ns[CONFIG_ZMK_BENCHMARK_MAX_SAMPLES];
+static uint32_t latencies_len;
+static uint32_t dropped_samples;
+
+static uint32_t events;
+static uint64_t first_event_ns;
+static uint64_t last_sample_ns;
+
+static bool sample_open;
+static uint64_t sample_start_ns;
+static uint64_t last_mark_ns;
+
+static uint64_t now_ns(void) {
+#if IS_ENABLED(CONFIG_ARCH_POSIX)
+    // Simulated kernel time doesn't advance while code runs on the host, so use the host clock.
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+#else
+    static uint32_t last_cycles;
+    static uint64_t total_cycles;
+
+    uint32_t cycles = k_cycle_get_32();
+    total_cycles += (uint32_t)(cycles - last_cycles);
+    last_cycles = cycles;
+
+    return k_cyc_to_ns_floor64(total_cycles);
+#endif
+}
+
+void zmk_benchmark_mark(enum zmk_benchmark_stage stage) {
+    uint64_t now = now_ns();
+
+    if (stage == ZMK_BENCHMARK_STAGE_KSCAN) {
+        if (events++ == 0) {
+            first_event_ns = now;
+        }
+
+        stage_stats[stage].count++;
+        sample_open = true;
+        sample_start_ns = now;
+        last_mark_ns = now;
+        return;
+    }
+
+    // Work triggered later by timers, e.g. hold-tap timeouts, isn't tied to a scanned event.
+    if (!sample_open) {
+        return;
+    }
+
+    uint32_t delta = (uint32_t)(now - last_mark_ns);
+    struct stage_stats *stats = &stage_stats[stage];
+    stats->count++;
+    stats->total_ns += delta;
+    stats->max_ns = MAX(stats->max_ns, delta);
+    last_mark_ns = now;
+
+    if (stage == ZMK_BENCHMARK_STAGE_ENDPOINT) {
+        sample_open = false;
+        last_sample_ns = now;
+
+        if (latencies_len < ARRAY_SIZE(latencies_ns)) {
+            latencies_ns[latencies_len++] = (uint32_t)(now - sample_start_ns);
+        } else {
+            dropped_samples++;
+        }
+    }
+}
+
+static void sort_latencies(void) {
+    for (int i = 1; i < latencies_len; i++) {
+        uint32_t val = latencies_ns[i];
+        int j = i - 1;
+
+        while (j >= 0 && latencies_ns[j] > val) {
+            latencies_ns[j + 1] = latencies_ns[j];
+            j--;
+        }
+
+        latencies_ns[j + 1] = val;
+    }
+}
+
+static uint32_t percentile(uint32_t pct) {
+    if (latencies_len == 0) {
+        return 0;
+    }
+
+    return latencies_ns[MIN(latencies_len - 1, (latencies_len * pct) / 100)];
+}
+
+void zmk_benchmark_report(void) {
+    for (int i = 0; i < ZMK_BENCHMARK_STAGE_COUNT; i++) {
+        const struct stage_stats *stats = &stage_stats[i];
+        printk("zmk_benchmark: {\"stage\":\"%s\",\"count\":%u,\"total_us\":%u,\"max_ns\":%u}\n",
+               stage_names[i], stats->count, (uint32_t)(stats->total_ns / NSEC_PER_USEC),
+               stats->max_ns);
+    }
+
+    sort_latencies();
+
+    uint64_t elapsed_ns = last_sample_ns > first_event_ns ? last_sample_ns - first_event_ns : 0;
+    uint32_t events_per_sec =
+        elapsed_ns > 0 ? (uint32_t)(((uint64_t)events * NSEC_PER_SEC) / elapsed_ns) : 0;
+
+    printk("zmk_benchmark: {\"events\":%u,\"samples\":%u,\"dropped\":%u,\"events_per_sec\":%u,"
+           "\"p50_ns\":%u,\"p99_ns\":%u}\n",
+           events, latencies_len, dropped_samples, events_per_sec, percentile(50),
+           percentile(99));
+
+    struct zmk_physical_layouts_kscan_stats kscan_stats;
+    zmk_physical_layouts_get_kscan_stats(&kscan_stats);
+
+    printk("zmk_benchmark: {\"kscan_queue_high_water\":%u,\"kscan_queue_dropped\":%u}\n",
+           kscan_stats.high_water, kscan_stats.dropped);
+}
+
+#if IS_ENABLED(CONFIG_ARCH_POSIX)
+
+// The mock kscan driver exits the process once its events are done, so report on the way out.
+static int benchmark_init(void) { return atexit(zmk_benchmark_report); }
+
+SYS_INIT(benchmark_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+#endif // IS_ENABLED(CONFIG_ARCH_POSIX)
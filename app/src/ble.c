@@ -32,6 +32,7 @@
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <zmk/ble.h>
+#include <zmk/endpoints.h>
 #include <zmk/keys.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/event_manager.h>
@@ -62,6 +63,9 @@ enum advertising_type {
 
 static struct zmk_ble_profile profiles[ZMK_BLE_PROFILE_COUNT];
 static uint8_t active_profile;
+static bool mirror_enabled;
+
+BUILD_ASSERT(ZMK_BLE_PROFILE_COUNT <= 32, "The output profile mask only covers 32 profiles");
 
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
@@ -76,11 +80,11 @@ static struct bt_data zmk_ble_ad[] = {
                   ),
 };
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#if ZMK_BLE_IS_CENTRAL
 
 static bt_addr_le_t peripheral_addrs[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
 
-#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) */
+#endif /* ZMK_BLE_IS_CENTRAL */
 
 static void raise_profile_changed_event(void) {
     raise_zmk_ble_active_profile_changed((struct zmk_ble_active_profile_changed){
@@ -112,13 +116,23 @@ void set_profile_address(uint8_t index, const bt_addr_le_t *addr) {
     k_work_submit(&raise_profile_changed_event_work);
 }
 
-bool zmk_ble_active_profile_is_connected(void) {
+struct bt_conn *zmk_ble_profile_conn(uint8_t index) {
+    if (index >= ZMK_BLE_PROFILE_COUNT) {
+        return NULL;
+    }
+
+    bt_addr_le_t *addr = &profiles[index].peer;
+    if (!bt_addr_le_cmp(addr, BT_ADDR_LE_ANY)) {
+        return NULL;
+    }
+
+    return bt_conn_lookup_addr_le(BT_ID_DEFAULT, addr);
+}
+
+bool zmk_ble_profile_is_connected(uint8_t index) {
     struct bt_conn *conn;
     struct bt_conn_info info;
-    bt_addr_le_t *addr = zmk_ble_active_profile_addr();
-    if (!bt_addr_le_cmp(addr, BT_ADDR_LE_ANY)) {
-        return false;
-    } else if ((conn = bt_conn_lookup_addr_le(BT_ID_DEFAULT, addr)) == NULL) {
+    if ((conn = zmk_ble_profile_conn(index)) == NULL) {
         return false;
     }
 
@@ -129,6 +143,10 @@ bool zmk_ble_active_profile_is_connected(void) {
     return info.state == BT_CONN_STATE_CONNECTED;
 }
 
+bool zmk_ble_active_profile_is_connected(void) {
+    return zmk_ble_profile_is_connected(active_profile);
+}
+
 #define CHECKED_ADV_STOP()                                                                         \
     err = bt_le_adv_stop();                                                                        \
     advertising_status = ZMK_ADV_NONE;                                                             \
@@ -161,6 +179,26 @@ bool zmk_ble_active_profile_is_connected(void) {
     }                                                                                              \
     advertising_status = ZMK_ADV_CONN;
 
+static void count_connection(struct bt_conn *conn, void *data) { (*(int *)data)++; }
+
+static bool should_advertise_for_bonded_profiles(void) {
+    // Connectable advertising needs a free connection, which split peripherals also use.
+    int connections = 0;
+    bt_conn_foreach(BT_CONN_TYPE_LE, count_connection, &connections);
+    if (connections >= CONFIG_BT_MAX_CONN) {
+        return false;
+    }
+
+    for (int i = 0; i < ZMK_BLE_PROFILE_COUNT; i++) {
+        if (bt_addr_le_cmp(&profiles[i].peer, BT_ADDR_LE_ANY) &&
+            !zmk_ble_profile_is_connected(i)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 int update_advertising(void) {
     int err = 0;
     bt_addr_le_t *addr;
@@ -178,6 +216,10 @@ int update_advertising(void) {
 
         // LOG_DBG("Directed advertising to %s", addr_str);
         // desired_adv = ZMK_ADV_DIR;
+    } else if (IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN) && should_advertise_for_bonded_profiles()) {
+        // Let the hosts of other profiles reconnect in the background, so switching to them
+        // doesn't have to wait for a reconnect.
+        desired_adv = ZMK_ADV_CONN;
     }
     LOG_DBG("advertising from %d to %d", advertising_status, desired_adv);
 
@@ -251,6 +293,9 @@ int zmk_ble_profile_index(const bt_addr_le_t *addr) {
 #if IS_ENABLED(CONFIG_SETTINGS)
 static void ble_save_profile_work(struct k_work *work) {
     settings_save_one("ble/active_profile", &active_profile, sizeof(active_profile));
+#if IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN)
+    settings_save_one("ble/mirror", &mirror_enabled, sizeof(mirror_enabled));
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN)
 }
 
 static struct k_work_delayable ble_save_work;
@@ -333,6 +378,49 @@ struct bt_conn *zmk_ble_active_profile_conn(void) {
     return conn;
 }
 
+bool zmk_ble_mirror_is_enabled(void) { return mirror_enabled; }
+
+int zmk_ble_set_mirror(bool enabled) {
+    if (!IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN)) {
+        return -ENOTSUP;
+    }
+
+    if (mirror_enabled == enabled) {
+        return 0;
+    }
+
+    LOG_DBG("Mirroring %s", enabled ? "enabled" : "disabled");
+
+    // Release everything first, so hosts that stop receiving reports aren't left with keys held
+    // and hosts that start receiving them don't see releases for presses they never saw.
+    if (zmk_endpoints_selected().transport == ZMK_TRANSPORT_BLE) {
+        zmk_endpoints_clear_current();
+    }
+
+    mirror_enabled = enabled;
+    ble_save_profile();
+
+    return 0;
+}
+
+int zmk_ble_toggle_mirror(void) { return zmk_ble_set_mirror(!mirror_enabled); }
+
+uint32_t zmk_ble_output_profiles(void) {
+    uint32_t output_profiles = BIT(active_profile);
+
+    if (!IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN) || !mirror_enabled) {
+        return output_profiles;
+    }
+
+    for (int i = 0; i < ZMK_BLE_PROFILE_COUNT; i++) {
+        if (zmk_ble_profile_is_connected(i)) {
+            output_profiles |= BIT(i);
+        }
+    }
+
+    return output_profiles;
+}
+
 char *zmk_ble_active_profile_name(void) { return profiles[active_profile].name; }
 
 int zmk_ble_set_device_name(char *name) {
@@ -355,7 +443,7 @@ int zmk_ble_set_device_name(char *name) {
     return update_advertising();
 }
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#if ZMK_BLE_IS_CENTRAL
 
 int zmk_ble_put_peripheral_addr(const bt_addr_le_t *addr) {
     for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
@@ -393,7 +481,7 @@ int zmk_ble_put_peripheral_addr(const bt_addr_le_t *addr) {
     return -ENOMEM;
 }
 
-#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) */
+#endif /* ZMK_BLE_IS_CENTRAL */
 
 #if IS_ENABLED(CONFIG_SETTINGS)
 
@@ -444,7 +532,20 @@ static int ble_profiles_handle_set(const char *name, size_t len, settings_read_c
             return err;
         }
     }
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#if IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN)
+    else if (settings_name_steq(name, "mirror", &next) && !next) {
+        if (len != sizeof(mirror_enabled)) {
+            return -EINVAL;
+        }
+
+        int err = read_cb(cb_arg, &mirror_enabled, sizeof(mirror_enabled));
+        if (err <= 0) {
+            LOG_ERR("Failed to handle mirror state from settings (err %d)", err);
+            return err;
+        }
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN)
+#if ZMK_BLE_IS_CENTRAL
     else if (settings_name_steq(name, "peripheral_addresses", &next) && next) {
         if (len != sizeof(bt_addr_le_t)) {
             return -EINVAL;
@@ -500,6 +601,14 @@ static void connected(struct bt_conn *conn, uint8_t err) {
 
     LOG_DBG("Connected %s", addr);
 
+    // While advertising only so bonded hosts can reconnect, don't let other hosts take a slot.
+    if (IS_ENABLED(CONFIG_ZMK_BLE_MULTI_CONN) && !zmk_ble_active_profile_is_open() &&
+        zmk_ble_profile_index(bt_conn_get_dst(conn)) < 0) {
+        LOG_WRN("Disconnecting %s, which is not bonded to any profile", addr);
+        bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+        return;
+    }
+
     update_advertising();
 
     if (is_conn_active_profile(conn)) {
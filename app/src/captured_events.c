@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/captured_events.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static inline uint16_t ring_index(const struct zmk_captured_events *ring, uint32_t offset) {
+    return (ring->head + offset) % ring->capacity;
+}
+
+static struct zmk_captured_event *claim_slot(struct zmk_captured_events *ring) {
+    if (ring->reserved + ring->len >= ring->capacity) {
+        ring->overflows++;
+        LOG_WRN("Captured event ring full (%d events), overflow count %d", ring->capacity,
+                ring->overflows);
+        return NULL;
+    }
+
+    return &ring->events[ring_index(ring, ring->len++)];
+}
+
+int zmk_captured_events_capture_position(struct zmk_captured_events *ring,
+                                         const struct zmk_position_state_changed *ev) {
+    struct zmk_captured_event *slot = claim_slot(ring);
+    if (slot == NULL) {
+        return -ENOMEM;
+    }
+
+    slot->tag = ZMK_CAPTURED_EVENT_POSITION;
+    slot->data.position = copy_raised_zmk_position_state_changed(ev);
+
+    if (ev->state && ev->position < ZMK_KEYMAP_LEN) {
+        ring->keydown_positions[ev->position / 32] |= BIT(ev->position % 32);
+    }
+
+    return 0;
+}
+
+int zmk_captured_events_capture_keycode(struct zmk_captured_events *ring,
+                                        const struct zmk_keycode_state_changed *ev) {
+    struct zmk_captured_event *slot = claim_slot(ring);
+    if (slot == NULL) {
+        return -ENOMEM;
+    }
+
+    slot->tag = ZMK_CAPTURED_EVENT_KEYCODE;
+    slot->data.keycode = copy_raised_zmk_keycode_state_changed(ev);
+
+    return 0;
+}
+
+bool zmk_captured_events_has_keydown(const struct zmk_captured_events *ring, uint32_t position) {
+    if (position < ZMK_KEYMAP_LEN) {
+        return (ring->keydown_positions[position / 32] & BIT(position % 32)) != 0;
+    }
+
+    // Positions outside the keymap aren't tracked in the bitmap.
+    for (uint32_t i = 0; i < ring->len; i++) {
+        const struct zmk_captured_event *ev = &ring->events[ring_index(ring, i)];
+        if (ev->tag == ZMK_CAPTURED_EVENT_POSITION && ev->data.position.data.position == position &&
+            ev->data.position.data.state) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// A nested replay frees its slots while the replay that owns the slots before them is still in
+// progress. Those slots are only reused once everything from tail up to them has been replayed
+// too, so new captures never wrap around onto events that are still waiting to be raised.
+static void release_replayed_slots(struct zmk_captured_events *ring) {
+    while (ring->reserved > 0 && ring->events[ring->tail].tag == ZMK_CAPTURED_EVENT_NONE) {
+        ring->tail = (ring->tail + 1) % ring->capacity;
+        ring->reserved--;
+    }
+}
+
+int zmk_captured_events_replay(struct zmk_captured_events *ring, zmk_captured_event_replay_cb cb,
+                               void *user_data) {
+    // Detach the pending events before raising any of them. Anything captured while they are
+    // replayed lands behind them, and a nested replay will only pick up those newer events.
+    uint16_t start = ring->head;
+    uint16_t count = ring->len;
+
+    ring->head = ring_index(ring, count);
+    ring->len = 0;
+    ring->reserved += count;
+    memset(ring->keydown_positions, 0, sizeof(ring->keydown_positions));
+
+    for (uint16_t i = 0; i < count; i++) {
+        struct zmk_captured_event *ev = &ring->events[(start + i) % ring->capacity];
+
+        cb(ev, user_data);
+
+        // The slot stays reserved until the callback returns, since the event is raised in place.
+        ev->tag = ZMK_CAPTURED_EVENT_NONE;
+        release_replayed_slots(ring);
+    }
+
+    return count;
+}
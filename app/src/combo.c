@@ -52,23 +52,38 @@ struct active_combo {
         key_positions_pressed[CONFIG_ZMK_COMBO_MAX_KEYS_PER_COMBO];
 };
 
-struct combo_candidate {
-    struct combo_cfg *combo;
-    // the time after which this behavior should be removed from candidates.
-    // by keeping track of when the candidate should be cleared there is no
-    // possibility of accidental releases.
-    int64_t timeout_at;
+#define COMBO_ONE(n) +1
+#define COMBOS_LEN (0 DT_INST_FOREACH_CHILD(0, COMBO_ONE))
+#define COMBO_SET_WORDS DIV_ROUND_UP(COMBOS_LEN, 32)
+#define COMBO_KEYS(n) +DT_PROP_LEN(n, key_positions)
+#define COMBO_KEYS_LEN (0 DT_INST_FOREACH_CHILD(0, COMBO_KEYS))
+
+struct combo_lookup_entry {
+    uint16_t position;
+    uint16_t combo;
 };
 
+// Sets of combos are bitmaps over the indexes in this array, which is
+// sorted shortest-first, then by virtual-key-position.
+struct combo_cfg *combos[COMBOS_LEN] = {NULL};
+int combos_len = 0;
+
 uint32_t pressed_keys_count = 0;
 // set of keys pressed
 struct zmk_position_state_changed_event pressed_keys[CONFIG_ZMK_COMBO_MAX_KEYS_PER_COMBO] = {};
 // the set of candidate combos based on the currently pressed_keys
-struct combo_candidate candidates[CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY];
+uint32_t candidates[COMBO_SET_WORDS] = {0};
+// the time of the first key press of the candidates. each candidate should be removed
+// once its timeout after this has passed. by keeping track of when the candidate should
+// be cleared there is no possibility of accidental releases.
+int64_t candidates_timestamp;
 // the last candidate that was completely pressed
 struct combo_cfg *fully_pressed_combo = NULL;
-// a lookup dict that maps a key position to all combos on that position
-struct combo_cfg *combo_lookup[ZMK_KEYMAP_LEN][CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY] = {NULL};
+// one entry per key of each combo, sorted by position then combo index, so the combos on a
+// position are a run of entries. this takes memory in proportion to the combos, not the keymap.
+// combos that failed to initialize have no entries, so only the first combo_lookup_len are used.
+struct combo_lookup_entry combo_lookup[COMBO_KEYS_LEN] = {};
+int combo_lookup_len = 0;
 // combos that have been activated and still have (some) keys pressed
 // this array is always contiguous from 0.
 struct active_combo active_combos[CONFIG_ZMK_COMBO_MAX_PRESSED_COMBOS] = {NULL};
@@ -88,8 +103,33 @@ static void store_last_tapped(int64_t timestamp) {
     }
 }
 
-// Store the combo key pointer in the combos array, one pointer for each key position
-// The combos are sorted shortest-first, then by virtual-key-position.
+// returns the index of the first combo in the set at or after start, or -1 if there are none.
+static int next_combo_in_set(const uint32_t *set, int start) {
+    for (int word = start / 32; word < COMBO_SET_WORDS; word++) {
+        uint32_t bits = set[word];
+        if (word == start / 32) {
+            bits &= ~BIT_MASK(start % 32);
+        }
+        if (bits != 0) {
+            return word * 32 + find_lsb_set(bits) - 1;
+        }
+    }
+    return -1;
+}
+
+#define FOR_EACH_COMBO_IN_SET(set, idx)                                                            \
+    for (int idx = next_combo_in_set(set, 0); idx >= 0; idx = next_combo_in_set(set, idx + 1))
+
+static int combo_set_count(const uint32_t *set) {
+    int count = 0;
+    for (int i = 0; i < COMBO_SET_WORDS; i++) {
+        count += popcount(set[i]);
+    }
+    return count;
+}
+
+// Store the combo pointer in the combos array, keeping it sorted shortest-first,
+// then by virtual-key-position.
 static int initialize_combo(struct combo_cfg *new_combo) {
     for (int i = 0; i < new_combo->key_position_len; i++) {
         int32_t position = new_combo->key_positions[i];
@@ -97,32 +137,63 @@ static int initialize_combo(struct combo_cfg *new_combo) {
             LOG_ERR("Unable to initialize combo, key position %d does not exist", position);
             return -EINVAL;
         }
+    }
 
-        struct combo_cfg *insert_combo = new_combo;
-        bool set = false;
-        for (int j = 0; j < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; j++) {
-            struct combo_cfg *combo_at_j = combo_lookup[position][j];
-            if (combo_at_j == NULL) {
-                combo_lookup[position][j] = insert_combo;
-                set = true;
-                break;
-            }
-            if (combo_at_j->key_position_len < insert_combo->key_position_len ||
-                (combo_at_j->key_position_len == insert_combo->key_position_len &&
-                 combo_at_j->virtual_key_position < insert_combo->virtual_key_position)) {
-                continue;
+    int j = combos_len++;
+    for (; j > 0; j--) {
+        struct combo_cfg *combo_before = combos[j - 1];
+        if (combo_before->key_position_len < new_combo->key_position_len ||
+            (combo_before->key_position_len == new_combo->key_position_len &&
+             combo_before->virtual_key_position < new_combo->virtual_key_position)) {
+            break;
+        }
+        // move combo_before up to make space for new_combo.
+        combos[j] = combo_before;
+    }
+    combos[j] = new_combo;
+
+    return 0;
+}
+
+// Add an entry for each key position of each combo, keeping the entries sorted.
+static void initialize_combo_lookup(void) {
+    for (int i = 0; i < combos_len; i++) {
+        struct combo_cfg *combo = combos[i];
+        for (int j = 0; j < combo->key_position_len; j++) {
+            struct combo_lookup_entry entry = {.position = combo->key_positions[j], .combo = i};
+            int k = combo_lookup_len++;
+            for (; k > 0; k--) {
+                struct combo_lookup_entry *entry_before = &combo_lookup[k - 1];
+                if (entry_before->position < entry.position ||
+                    (entry_before->position == entry.position &&
+                     entry_before->combo < entry.combo)) {
+                    break;
+                }
+                // move entry_before up to make space for entry.
+                combo_lookup[k] = *entry_before;
             }
-            // put insert_combo in this spot, move all other combos up.
-            combo_lookup[position][j] = insert_combo;
-            insert_combo = combo_at_j;
+            combo_lookup[k] = entry;
         }
-        if (!set) {
-            LOG_ERR("Too many combos for key position %d, CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY %d.",
-                    position, CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY);
-            return -ENOMEM;
+    }
+}
+
+// Fill set with the combos on a key position.
+static void combos_on_position(int32_t position, uint32_t *set) {
+    // find the first entry for the position.
+    int lo = 0, hi = combo_lookup_len;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (combo_lookup[mid].position < position) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
-    return 0;
+
+    memset(set, 0, COMBO_SET_WORDS * sizeof(uint32_t));
+    for (int i = lo; i < combo_lookup_len && combo_lookup[i].position == position; i++) {
+        set[combo_lookup[i].combo / 32] |= BIT(combo_lookup[i].combo % 32);
+    }
 }
 
 static bool combo_active_on_layer(struct combo_cfg *combo, uint8_t layer) {
@@ -145,63 +216,41 @@ static bool is_quick_tap(struct combo_cfg *combo, int64_t timestamp) {
 static int setup_candidates_for_first_keypress(int32_t position, int64_t timestamp) {
     int number_of_combo_candidates = 0;
     uint8_t highest_active_layer = zmk_keymap_highest_layer_active();
-    for (int i = 0; i < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; i++) {
-        struct combo_cfg *combo = combo_lookup[position][i];
-        if (combo == NULL) {
-            return number_of_combo_candidates;
-        }
+    uint32_t on_position[COMBO_SET_WORDS];
+    combos_on_position(position, on_position);
+    candidates_timestamp = timestamp;
+    FOR_EACH_COMBO_IN_SET(on_position, i) {
+        struct combo_cfg *combo = combos[i];
         if (combo_active_on_layer(combo, highest_active_layer) && !is_quick_tap(combo, timestamp)) {
-            candidates[number_of_combo_candidates].combo = combo;
-            candidates[number_of_combo_candidates].timeout_at = timestamp + combo->timeout_ms;
+            candidates[i / 32] |= BIT(i % 32);
             number_of_combo_candidates++;
         }
-        // LOG_DBG("combo timeout %d %d %d", position, i, candidates[i].timeout_at);
     }
     return number_of_combo_candidates;
 }
 
 static int filter_candidates(int32_t position) {
-    // this code iterates over candidates and the lookup together to filter in O(n)
-    // assuming they are both sorted on key_position_len, virtual_key_position
-    int matches = 0, lookup_idx = 0, candidate_idx = 0;
-    while (lookup_idx < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY &&
-           candidate_idx < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY) {
-        struct combo_cfg *candidate = candidates[candidate_idx].combo;
-        struct combo_cfg *lookup = combo_lookup[position][lookup_idx];
-        if (candidate == NULL || lookup == NULL) {
-            break;
-        }
-        if (candidate->virtual_key_position == lookup->virtual_key_position) {
-            candidates[matches] = candidates[candidate_idx];
-            matches++;
-            candidate_idx++;
-            lookup_idx++;
-        } else if (candidate->key_position_len > lookup->key_position_len) {
-            lookup_idx++;
-        } else if (candidate->key_position_len < lookup->key_position_len) {
-            candidate_idx++;
-        } else if (candidate->virtual_key_position > lookup->virtual_key_position) {
-            lookup_idx++;
-        } else if (candidate->virtual_key_position < lookup->virtual_key_position) {
-            candidate_idx++;
-        }
-    }
-    // clear unmatched candidates
-    for (int i = matches; i < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; i++) {
-        candidates[i].combo = NULL;
+    // keep only the candidates that also use this position
+    uint32_t on_position[COMBO_SET_WORDS];
+    combos_on_position(position, on_position);
+    for (int i = 0; i < COMBO_SET_WORDS; i++) {
+        candidates[i] &= on_position[i];
     }
-    // LOG_DBG("combo matches after filter %d", matches);
-    return matches;
+    return combo_set_count(candidates);
+}
+
+// returns the shortest candidate, or NULL if there are none.
+static struct combo_cfg *first_candidate() {
+    int idx = next_combo_in_set(candidates, 0);
+    return idx >= 0 ? combos[idx] : NULL;
 }
 
 static int64_t first_candidate_timeout() {
-    int64_t first_timeout = LONG_MAX;
-    for (int i = 0; i < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; i++) {
-        if (candidates[i].combo == NULL) {
-            break;
-        }
-        if (candidates[i].timeout_at < first_timeout) {
-            first_timeout = candidates[i].timeout_at;
+    int64_t first_timeout = LLONG_MAX;
+    FOR_EACH_COMBO_IN_SET(candidates, i) {
+        int64_t timeout_at = candidates_timestamp + combos[i]->timeout_ms;
+        if (timeout_at < first_timeout) {
+            first_timeout = timeout_at;
         }
     }
     return first_timeout;
@@ -220,25 +269,11 @@ static int cleanup();
 
 static int filter_timed_out_candidates(int64_t timestamp) {
     int remaining_candidates = 0;
-    for (int i = 0; i < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; i++) {
-        struct combo_candidate *candidate = &candidates[i];
-        if (candidate->combo == NULL) {
-            break;
-        }
-        if (candidate->timeout_at > timestamp) {
-            bool need_to_bubble_up = remaining_candidates != i;
-            if (need_to_bubble_up) {
-                // bubble up => reorder candidates so they're contiguous
-                candidates[remaining_candidates].combo = candidate->combo;
-                candidates[remaining_candidates].timeout_at = candidate->timeout_at;
-                // clear the previous location
-                candidates[i].combo = NULL;
-                candidates[i].timeout_at = 0;
-            }
-
+    FOR_EACH_COMBO_IN_SET(candidates, i) {
+        if (candidates_timestamp + combos[i]->timeout_ms > timestamp) {
             remaining_candidates++;
         } else {
-            candidate->combo = NULL;
+            candidates[i / 32] &= ~BIT(i % 32);
         }
     }
 
@@ -250,17 +285,13 @@ static int filter_timed_out_candidates(int64_t timestamp) {
 }
 
 static int clear_candidates() {
-    for (int i = 0; i < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; i++) {
-        if (candidates[i].combo == NULL) {
-            return i;
-        }
-        candidates[i].combo = NULL;
-    }
-    return CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY;
+    int count = combo_set_count(candidates);
+    memset(candidates, 0, sizeof(candidates));
+    return count;
 }
 
 static int capture_pressed_key(const struct zmk_position_state_changed *ev) {
-    if (pressed_keys_count == CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY) {
+    if (pressed_keys_count == ARRAY_SIZE(pressed_keys)) {
         return ZMK_EV_EVENT_BUBBLE;
     }
 
@@ -427,7 +458,7 @@ static void update_timeout_task() {
 
 static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_changed *data) {
     int num_candidates;
-    if (candidates[0].combo == NULL) {
+    if (first_candidate() == NULL) {
         num_candidates = setup_candidates_for_first_keypress(data->position, data->timestamp);
         if (num_candidates == 0) {
             return ZMK_EV_EVENT_BUBBLE;
@@ -438,7 +469,7 @@ static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_
     }
     update_timeout_task();
 
-    struct combo_cfg *candidate_combo = candidates[0].combo;
+    struct combo_cfg *candidate_combo = first_candidate();
     LOG_DBG("combo: capturing position event %d", data->position);
     int ret = capture_pressed_key(data);
     switch (num_candidates) {
@@ -540,6 +571,7 @@ DT_INST_FOREACH_CHILD(0, COMBO_INST)
 static int combo_init(void) {
     k_work_init_delayable(&timeout_task, combo_timeout_handler);
     DT_INST_FOREACH_CHILD(0, INITIALIZE_COMBO);
+    initialize_combo_lookup();
     return 0;
 }
 
@@ -8,7 +8,9 @@
 #include <zephyr/settings/settings.h>
 
 #include <stdio.h>
+#include <string.h>
 
+#include <zmk/benchmark.h>
 #include <zmk/ble.h>
 #include <zmk/endpoints.h>
 #include <zmk/hid.h>
@@ -48,6 +50,45 @@ static int endpoints_save_preferred(void) {
 #endif
 }
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+// Indexed by zmk_endpoint_instance_to_index(). Saved under the endpoint's string, since the index
+// may change between firmware versions.
+static uint8_t keyboard_report_types[ZMK_ENDPOINT_COUNT];
+
+static struct zmk_endpoint_instance endpoint_instance_from_index(int index);
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+#define KEYBOARD_REPORT_SETTING_PREFIX "endpoints/keyboard_report/"
+
+static void endpoints_save_report_types_work(struct k_work *work) {
+    for (int i = 0; i < ZMK_ENDPOINT_COUNT; i++) {
+        char endpoint_str[ZMK_ENDPOINT_STR_LEN];
+        char setting_name[sizeof(KEYBOARD_REPORT_SETTING_PREFIX) + ZMK_ENDPOINT_STR_LEN];
+
+        zmk_endpoint_instance_to_str(endpoint_instance_from_index(i), endpoint_str,
+                                     sizeof(endpoint_str));
+        snprintf(setting_name, sizeof(setting_name), KEYBOARD_REPORT_SETTING_PREFIX "%s",
+                 endpoint_str);
+        settings_save_one(setting_name, &keyboard_report_types[i],
+                          sizeof(keyboard_report_types[i]));
+    }
+}
+
+static struct k_work_delayable endpoints_save_report_types_work_item;
+#endif // IS_ENABLED(CONFIG_SETTINGS)
+
+static int endpoints_save_report_types(void) {
+#if IS_ENABLED(CONFIG_SETTINGS)
+    return k_work_reschedule(&endpoints_save_report_types_work_item,
+                             K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
+#else
+    return 0;
+#endif
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 bool zmk_endpoint_instance_eq(struct zmk_endpoint_instance a, struct zmk_endpoint_instance b) {
     if (a.transport != b.transport) {
         return false;
@@ -94,6 +135,62 @@ int zmk_endpoint_instance_to_index(struct zmk_endpoint_instance endpoint) {
     return 0;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+static struct zmk_endpoint_instance endpoint_instance_from_index(int index) {
+    if (index < INSTANCE_INDEX_OFFSET_BLE) {
+        return (struct zmk_endpoint_instance){.transport = ZMK_TRANSPORT_USB};
+    }
+
+    return (struct zmk_endpoint_instance){
+        .transport = ZMK_TRANSPORT_BLE,
+        .ble = {.profile_index = index - INSTANCE_INDEX_OFFSET_BLE},
+    };
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+enum zmk_hid_keyboard_report_type
+zmk_endpoints_keyboard_report_type(struct zmk_endpoint_instance endpoint) {
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    return keyboard_report_types[zmk_endpoint_instance_to_index(endpoint)];
+#elif IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_NKRO)
+    return ZMK_HID_KEYBOARD_REPORT_TYPE_NKRO;
+#else
+    return ZMK_HID_KEYBOARD_REPORT_TYPE_HKRO;
+#endif
+}
+
+int zmk_endpoints_set_keyboard_report_type(struct zmk_endpoint_instance endpoint,
+                                           enum zmk_hid_keyboard_report_type type) {
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    if (type != ZMK_HID_KEYBOARD_REPORT_TYPE_NKRO && type != ZMK_HID_KEYBOARD_REPORT_TYPE_HKRO) {
+        return -EINVAL;
+    }
+
+    const int index = zmk_endpoint_instance_to_index(endpoint);
+    if (keyboard_report_types[index] == type) {
+        return 0;
+    }
+
+    if (zmk_endpoint_instance_eq(endpoint, current_instance)) {
+        // Release all keys in the old report, or the host would see them stay held.
+        zmk_endpoints_clear_current();
+    }
+
+    keyboard_report_types[index] = type;
+
+    char endpoint_str[ZMK_ENDPOINT_STR_LEN];
+    zmk_endpoint_instance_to_str(endpoint, endpoint_str, sizeof(endpoint_str));
+    LOG_INF("Keyboard report for %s set to %s", endpoint_str,
+            type == ZMK_HID_KEYBOARD_REPORT_TYPE_HKRO ? "HKRO" : "NKRO");
+
+    return endpoints_save_report_types();
+#else
+    return -ENOTSUP;
+#endif
+}
+
 int zmk_endpoints_select_transport(enum zmk_transport transport) {
     LOG_DBG("Selected endpoint transport %d", transport);
 
@@ -118,6 +215,20 @@ int zmk_endpoints_toggle_transport(void) {
 
 struct zmk_endpoint_instance zmk_endpoints_selected(void) { return current_instance; }
 
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+static int send_hog_keyboard_report(void) {
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    if (zmk_endpoints_keyboard_report_type(current_instance) == ZMK_HID_KEYBOARD_REPORT_TYPE_HKRO) {
+        struct zmk_hid_keyboard_hkro_report *hkro_report = zmk_hid_get_keyboard_hkro_report();
+        return zmk_hog_send_keyboard_hkro_report(&hkro_report->body);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+    struct zmk_hid_keyboard_report *keyboard_report = zmk_hid_get_keyboard_report();
+    return zmk_hog_send_keyboard_report(&keyboard_report->body);
+}
+#endif // IS_ENABLED(CONFIG_ZMK_BLE)
+
 static int send_keyboard_report(void) {
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_USB: {
@@ -135,8 +246,7 @@ static int send_keyboard_report(void) {
 
     case ZMK_TRANSPORT_BLE: {
 #if IS_ENABLED(CONFIG_ZMK_BLE)
-        struct zmk_hid_keyboard_report *keyboard_report = zmk_hid_get_keyboard_report();
-        int err = zmk_hog_send_keyboard_report(&keyboard_report->body);
+        int err = send_hog_keyboard_report();
         if (err) {
             LOG_ERR("FAILED TO SEND OVER HOG: %d", err);
         }
@@ -189,6 +299,7 @@ static int send_consumer_report(void) {
 int zmk_endpoints_send_report(uint16_t usage_page) {
 
     LOG_DBG("usage page 0x%02X", usage_page);
+    zmk_benchmark_mark(ZMK_BENCHMARK_STAGE_ENDPOINT);
     switch (usage_page) {
     case HID_USAGE_KEY:
         return send_keyboard_report();
@@ -258,6 +369,32 @@ static int endpoints_handle_set(const char *name, size_t len, settings_read_cb r
         update_current_endpoint();
     }
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    const char *next;
+    if (settings_name_steq(name, "keyboard_report", &next) && next) {
+        for (int i = 0; i < ZMK_ENDPOINT_COUNT; i++) {
+            char endpoint_str[ZMK_ENDPOINT_STR_LEN];
+            zmk_endpoint_instance_to_str(endpoint_instance_from_index(i), endpoint_str,
+                                         sizeof(endpoint_str));
+            if (strcmp(next, endpoint_str) != 0) {
+                continue;
+            }
+
+            if (len != sizeof(keyboard_report_types[i])) {
+                LOG_ERR("Invalid keyboard report type size (got %d expected %d)", len,
+                        sizeof(keyboard_report_types[i]));
+                return -EINVAL;
+            }
+
+            int err = read_cb(cb_arg, &keyboard_report_types[i], sizeof(keyboard_report_types[i]));
+            if (err <= 0) {
+                LOG_ERR("Failed to read keyboard report type from settings (err %d)", err);
+                return err;
+            }
+        }
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
     return 0;
 }
 
@@ -322,6 +459,10 @@ static struct zmk_endpoint_instance get_selected_instance(void) {
 static int zmk_endpoints_init(void) {
 #if IS_ENABLED(CONFIG_SETTINGS)
     k_work_init_delayable(&endpoints_save_work, endpoints_save_preferred_work);
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    k_work_init_delayable(&endpoints_save_report_types_work_item,
+                          endpoints_save_report_types_work);
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
 #endif
 
     current_instance = get_selected_instance();
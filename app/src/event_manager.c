@@ -14,17 +14,31 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 extern struct zmk_event_type *__event_type_start[];
 extern struct zmk_event_type *__event_type_end[];
 
-extern struct zmk_event_subscription __event_subscriptions_start[];
-extern struct zmk_event_subscription __event_subscriptions_end[];
+// Index of a listener within the subscriptions of the event's type, or -ENOENT if not subscribed.
+static int find_listener_index(const zmk_event_t *event, const struct zmk_listener *listener) {
+    const struct zmk_event_subscription *subs = event->event->subscriptions_start;
+    uint8_t len = event->event->subscriptions_end - subs;
+
+    // Events re-raised by the listener that captured them already carry its index.
+    if (event->last_listener_index < len && subs[event->last_listener_index].listener == listener) {
+        return event->last_listener_index;
+    }
+
+    for (int i = 0; i < len; i++) {
+        if (subs[i].listener == listener) {
+            return i;
+        }
+    }
+
+    return -ENOENT;
+}
 
 int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
     int ret = 0;
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
+    const struct zmk_event_subscription *subs = event->event->subscriptions_start;
+    uint8_t len = event->event->subscriptions_end - subs;
     for (int i = start_index; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-        if (ev_sub->event_type != event->event) {
-            continue;
-        }
+        const struct zmk_event_subscription *ev_sub = subs + i;
         event->last_listener_index = i;
         ret = ev_sub->listener->callback(event);
         switch (ret) {
@@ -48,13 +62,9 @@ int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
 int zmk_event_manager_raise(zmk_event_t *event) { return zmk_event_manager_handle_from(event, 0); }
 
 int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i + 1);
-        }
+    int index = find_listener_index(event, listener);
+    if (index >= 0) {
+        return zmk_event_manager_handle_from(event, index + 1);
     }
 
     LOG_WRN("Unable to find where to raise this after event");
@@ -63,13 +73,9 @@ int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener
 }
 
 int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i);
-        }
+    int index = find_listener_index(event, listener);
+    if (index >= 0) {
+        return zmk_event_manager_handle_from(event, index);
     }
 
     LOG_WRN("Unable to find where to raise this event");
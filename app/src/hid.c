@@ -18,6 +18,14 @@ static struct zmk_hid_keyboard_report keyboard_report = {
 static struct zmk_hid_consumer_report consumer_report = {.report_id = ZMK_HID_REPORT_ID_CONSUMER,
                                                          .body = {.keys = {0}}};
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+static struct zmk_hid_keyboard_hkro_report keyboard_hkro_report = {
+    .report_id = ZMK_HID_REPORT_ID_KEYBOARD_HKRO,
+    .body = {.modifiers = 0, ._reserved = 0, .keys = {0}}};
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 
 static zmk_hid_boot_report_t boot_report = {.modifiers = 0, ._reserved = 0, .keys = {0}};
@@ -50,6 +58,8 @@ static zmk_mod_flags_t masked_modifiers = 0;
 
 zmk_mod_flags_t zmk_hid_get_explicit_mods(void) { return explicit_modifiers; }
 
+zmk_mod_flags_t zmk_hid_get_implicit_mods(void) { return implicit_modifiers; }
+
 int zmk_hid_register_mod(zmk_mod_t modifier) {
     explicit_modifier_counts[modifier]++;
     LOG_DBG("Modifier %d count %d", modifier, explicit_modifier_counts[modifier]);
@@ -174,6 +184,34 @@ static inline bool check_keyboard_usage(zmk_key_t usage) {
     return keyboard_report.body.keys[usage / 8] & (1 << (usage % 8));
 }
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+struct zmk_hid_keyboard_hkro_report *zmk_hid_get_keyboard_hkro_report(void) {
+    struct zmk_hid_keyboard_hkro_report_body *body = &keyboard_hkro_report.body;
+
+    body->modifiers = keyboard_report.body.modifiers;
+    memset(&body->keys, 0, sizeof(body->keys));
+
+    int ix = 0;
+    for (int i = 0; i < sizeof(keyboard_report.body.keys); ++i) {
+        if (!keyboard_report.body.keys[i]) {
+            continue;
+        }
+        for (int j = 0; j < 8; ++j) {
+            if (!(keyboard_report.body.keys[i] & BIT(j))) {
+                continue;
+            }
+            if (ix == ARRAY_SIZE(body->keys)) {
+                memset(&body->keys, HID_ERROR_ROLLOVER, sizeof(body->keys));
+                return &keyboard_hkro_report;
+            }
+            body->keys[ix++] = i * 8 + j;
+        }
+    }
+
+    return &keyboard_hkro_report;
+}
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #elif IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO)
 
 #define TOGGLE_KEYBOARD(match, val)                                                                \
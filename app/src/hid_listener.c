@@ -4,11 +4,14 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <string.h>
+
 #include <drivers/behavior.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <zmk/benchmark.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/keycode_state_changed.h>
 #include <zmk/events/modifiers_state_changed.h>
@@ -16,6 +19,114 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <dt-bindings/zmk/hid_usage_pages.h>
 #include <zmk/endpoints.h>
 
+enum hid_change {
+    HID_CHANGE_PRESS,
+    HID_CHANGE_RELEASE,
+    // Both presses and releases, e.g. a key press that replaces the current implicit modifiers.
+    HID_CHANGE_MIXED,
+};
+
+#if IS_ENABLED(CONFIG_ZMK_HID_REPORT_COALESCING)
+
+struct pending_report {
+    uint16_t usage_page;
+    enum hid_change change;
+    int64_t timestamp;
+};
+
+// Usage pages with unsent changes, in the order they were first changed.
+static struct pending_report pending_reports[2];
+static size_t pending_reports_len;
+
+static struct pending_report *hid_listener_find_pending(uint16_t usage_page) {
+    for (size_t i = 0; i < pending_reports_len; i++) {
+        if (pending_reports[i].usage_page == usage_page) {
+            return &pending_reports[i];
+        }
+    }
+    return NULL;
+}
+
+static int hid_listener_flush_report(uint16_t usage_page) {
+    struct pending_report *pending = hid_listener_find_pending(usage_page);
+    if (pending == NULL) {
+        return 0;
+    }
+
+    size_t idx = pending - pending_reports;
+    memmove(pending, pending + 1, (pending_reports_len - idx - 1) * sizeof(*pending));
+    pending_reports_len--;
+
+    LOG_DBG("usage page 0x%02X", usage_page);
+    return zmk_endpoints_send_report(usage_page);
+}
+
+static int hid_listener_flush_reports(void) {
+    int ret = 0;
+    while (pending_reports_len > 0) {
+        int err = hid_listener_flush_report(pending_reports[0].usage_page);
+        if (err < 0) {
+            LOG_ERR("Failed to send coalesced report (%d)", err);
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+static void hid_listener_flush_work_cb(struct k_work *work) { hid_listener_flush_reports(); }
+
+static K_WORK_DEFINE(hid_listener_flush_work, hid_listener_flush_work_cb);
+
+// Changes to a usage page are merged into one report as long as they happened at the same time
+// and all go in the same direction. Anything else has to send the pending changes first, e.g.
+// pressing and releasing a key within one batch, or the host would never see some of them, and
+// two presses replayed by a hold-tap, or the host would lose their order.
+static void hid_listener_begin_change(uint16_t usage_page, enum hid_change change,
+                                      int64_t timestamp) {
+    struct pending_report *pending = hid_listener_find_pending(usage_page);
+    if (pending != NULL && (pending->change != change || change == HID_CHANGE_MIXED ||
+                            pending->timestamp != timestamp)) {
+        int err = hid_listener_flush_report(usage_page);
+        if (err < 0) {
+            LOG_ERR("Failed to send coalesced report (%d)", err);
+        }
+    }
+}
+
+static int hid_listener_end_change(uint16_t usage_page, enum hid_change change,
+                                   int64_t timestamp) {
+    struct pending_report *pending = hid_listener_find_pending(usage_page);
+    if (pending == NULL) {
+        if (pending_reports_len == ARRAY_SIZE(pending_reports)) {
+            return zmk_endpoints_send_report(usage_page);
+        }
+        pending = &pending_reports[pending_reports_len++];
+        pending->usage_page = usage_page;
+    }
+    pending->change = change;
+    pending->timestamp = timestamp;
+
+    // Flush once the work currently being processed, e.g. a kscan batch, is done.
+    k_work_submit(&hid_listener_flush_work);
+    return 0;
+}
+
+#else
+
+static inline int hid_listener_flush_report(uint16_t usage_page) { return 0; }
+
+static inline int hid_listener_flush_reports(void) { return 0; }
+
+static inline void hid_listener_begin_change(uint16_t usage_page, enum hid_change change,
+                                             int64_t timestamp) {}
+
+static inline int hid_listener_end_change(uint16_t usage_page, enum hid_change change,
+                                          int64_t timestamp) {
+    return zmk_endpoints_send_report(usage_page);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_REPORT_COALESCING)
+
 static int hid_listener_keycode_pressed(const struct zmk_keycode_state_changed *ev) {
     int err, explicit_mods_changed, implicit_mods_changed;
 
@@ -23,12 +134,13 @@ static int hid_listener_keycode_pressed(const struct zmk_keycode_state_changed *
         zmk_hid_is_pressed(ZMK_HID_USAGE(ev->usage_page, ev->keycode))) {
         LOG_DBG("unregistering usage_page 0x%02X keycode 0x%02X since it was already pressed",
                 ev->usage_page, ev->keycode);
+        hid_listener_begin_change(ev->usage_page, HID_CHANGE_RELEASE, ev->timestamp);
         err = zmk_hid_release(ZMK_HID_USAGE(ev->usage_page, ev->keycode));
         if (err < 0) {
             LOG_DBG("Unable to pre-release keycode (%d)", err);
             return err;
         }
-        err = zmk_endpoints_send_report(ev->usage_page);
+        err = hid_listener_end_change(ev->usage_page, HID_CHANGE_RELEASE, ev->timestamp);
         if (err < 0) {
             LOG_ERR("Failed to send key report for pre-releasing keycode (%d)", err);
         }
@@ -36,6 +148,21 @@ static int hid_listener_keycode_pressed(const struct zmk_keycode_state_changed *
 
     LOG_DBG("usage_page 0x%02X keycode 0x%02X implicit_mods 0x%02X explicit_mods 0x%02X",
             ev->usage_page, ev->keycode, ev->implicit_modifiers, ev->explicit_modifiers);
+
+    // Pressing a key replaces the implicit modifiers of the previously pressed one.
+    enum hid_change mods_change = (zmk_hid_get_implicit_mods() & ~ev->implicit_modifiers)
+                                      ? HID_CHANGE_MIXED
+                                      : HID_CHANGE_PRESS;
+    if (ev->usage_page == HID_USAGE_KEY) {
+        hid_listener_begin_change(HID_USAGE_KEY, mods_change, ev->timestamp);
+    } else {
+        if (ev->explicit_modifiers || ev->implicit_modifiers || zmk_hid_get_implicit_mods()) {
+            // Keep any modifier change ahead of the report for the other usage page.
+            hid_listener_flush_reports();
+        }
+        hid_listener_begin_change(ev->usage_page, HID_CHANGE_PRESS, ev->timestamp);
+    }
+
     err = zmk_hid_press(ZMK_HID_USAGE(ev->usage_page, ev->keycode));
     if (err < 0) {
         LOG_DBG("Unable to press keycode");
@@ -45,14 +172,16 @@ static int hid_listener_keycode_pressed(const struct zmk_keycode_state_changed *
     implicit_mods_changed = zmk_hid_implicit_modifiers_press(ev->implicit_modifiers);
     if (ev->usage_page != HID_USAGE_KEY &&
         (explicit_mods_changed > 0 || implicit_mods_changed > 0)) {
-        err = zmk_endpoints_send_report(HID_USAGE_KEY);
+        err = hid_listener_end_change(HID_USAGE_KEY, mods_change, ev->timestamp);
         if (err < 0) {
             LOG_ERR("Failed to send key report for changed mofifiers for consumer page event (%d)",
                     err);
         }
     }
 
-    return zmk_endpoints_send_report(ev->usage_page);
+    return hid_listener_end_change(ev->usage_page,
+                                   ev->usage_page == HID_USAGE_KEY ? mods_change : HID_CHANGE_PRESS,
+                                   ev->timestamp);
 }
 
 static int hid_listener_keycode_released(const struct zmk_keycode_state_changed *ev) {
@@ -60,6 +189,14 @@ static int hid_listener_keycode_released(const struct zmk_keycode_state_changed
 
     LOG_DBG("usage_page 0x%02X keycode 0x%02X implicit_mods 0x%02X explicit_mods 0x%02X",
             ev->usage_page, ev->keycode, ev->implicit_modifiers, ev->explicit_modifiers);
+
+    bool mods_may_change = ev->explicit_modifiers || zmk_hid_get_implicit_mods();
+    if (ev->usage_page != HID_USAGE_KEY && mods_may_change) {
+        // Keep any modifier change ahead of the report for the other usage page.
+        hid_listener_flush_reports();
+    }
+    hid_listener_begin_change(ev->usage_page, HID_CHANGE_RELEASE, ev->timestamp);
+
     err = zmk_hid_release(ZMK_HID_USAGE(ev->usage_page, ev->keycode));
     if (err < 0) {
         LOG_DBG("Unable to release keycode");
@@ -70,7 +207,10 @@ static int hid_listener_keycode_released(const struct zmk_keycode_state_changed
 
     // send report of normal key release early to fix the issue
     // of some programs recognizing the implicit_mod release before the actual key release
-    err = zmk_endpoints_send_report(ev->usage_page);
+    err = hid_listener_end_change(ev->usage_page, HID_CHANGE_RELEASE, ev->timestamp);
+    if (err >= 0 && mods_may_change) {
+        err = hid_listener_flush_report(ev->usage_page);
+    }
     if (err < 0) {
         LOG_ERR("Failed to send key report for the released keycode (%d)", err);
     }
@@ -87,18 +227,19 @@ static int hid_listener_keycode_released(const struct zmk_keycode_state_changed
 
     if (ev->usage_page != HID_USAGE_KEY &&
         (explicit_mods_changed > 0 || implicit_mods_changed > 0)) {
-        err = zmk_endpoints_send_report(HID_USAGE_KEY);
+        err = hid_listener_end_change(HID_USAGE_KEY, HID_CHANGE_RELEASE, ev->timestamp);
         if (err < 0) {
             LOG_ERR("Failed to send key report for changed mofifiers for consumer page event (%d)",
                     err);
         }
     }
-    return zmk_endpoints_send_report(ev->usage_page);
+    return hid_listener_end_change(ev->usage_page, HID_CHANGE_RELEASE, ev->timestamp);
 }
 
 int hid_listener(const zmk_event_t *eh) {
     const struct zmk_keycode_state_changed *ev = as_zmk_keycode_state_changed(eh);
     if (ev) {
+        zmk_benchmark_mark(ZMK_BENCHMARK_STAGE_HID);
         if (ev->state) {
             hid_listener_keycode_pressed(ev);
         } else {
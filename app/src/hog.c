@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <string.h>
+
 #include <zephyr/settings/settings.h>
 #include <zephyr/init.h>
 
@@ -72,6 +74,15 @@ static struct hids_report consumer_input = {
     .type = HIDS_INPUT,
 };
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+static struct hids_report keyboard_hkro_input = {
+    .id = ZMK_HID_REPORT_ID_KEYBOARD_HKRO,
+    .type = HIDS_INPUT,
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 
 static struct hids_report mouse_input = {
@@ -155,6 +166,19 @@ static ssize_t read_hids_consumer_input_report(struct bt_conn *conn,
                              sizeof(struct zmk_hid_consumer_report_body));
 }
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+static ssize_t read_hids_keyboard_hkro_input_report(struct bt_conn *conn,
+                                                    const struct bt_gatt_attr *attr, void *buf,
+                                                    uint16_t len, uint16_t offset) {
+    struct zmk_hid_keyboard_hkro_report_body *report_body =
+        &zmk_hid_get_keyboard_hkro_report()->body;
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, report_body,
+                             sizeof(struct zmk_hid_keyboard_hkro_report_body));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 
 static ssize_t read_hids_mouse_input_report(struct bt_conn *conn, const struct bt_gatt_attr *attr,
@@ -269,6 +293,15 @@ BT_GATT_SERVICE_DEFINE(
 
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    BT_GATT_CHARACTERISTIC(BT_UUID_HIDS_REPORT, BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_READ_ENCRYPT, read_hids_keyboard_hkro_input_report, NULL,
+                           NULL),
+    BT_GATT_CCC(input_ccc_changed, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
+    BT_GATT_DESCRIPTOR(BT_UUID_HIDS_REPORT_REF, BT_GATT_PERM_READ_ENCRYPT, read_hids_report_ref,
+                       NULL, &keyboard_hkro_input),
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 #if IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
     BT_GATT_CHARACTERISTIC(BT_UUID_HIDS_REPORT,
                            BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
@@ -285,165 +318,506 @@ K_THREAD_STACK_DEFINE(hog_q_stack, CONFIG_ZMK_BLE_THREAD_STACK_SIZE);
 
 struct k_work_q hog_work_q;
 
-K_MSGQ_DEFINE(zmk_hog_keyboard_msgq, sizeof(struct zmk_hid_keyboard_report_body),
-              CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE, 4);
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
 
-void send_keyboard_report_callback(struct k_work *work) {
-    struct zmk_hid_keyboard_report_body report;
+// The HKRO report follows the mouse reports, so existing attribute indices are unchanged.
+#define HOG_KEYBOARD_HKRO_ATTR_INDEX                                                               \
+    (13 + (IS_ENABLED(CONFIG_ZMK_POINTING) ? 4 : 0) +                                              \
+     (IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING) ? 3 : 0))
 
-    while (k_msgq_get(&zmk_hog_keyboard_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
-        }
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[5],
-            .data = &report,
-            .len = sizeof(report),
-        };
+union hog_any_report {
+    struct zmk_hid_keyboard_report_body keyboard;
+    struct zmk_hid_consumer_report_body consumer;
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    struct zmk_hid_keyboard_hkro_report_body keyboard_hkro;
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct zmk_hid_mouse_report_body mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
+/*
+ * Every report type has a queue per profile, so the same report can be sent to several connected
+ * hosts, and reports for one host are never sent to another after a profile switch.
+ *
+ * Only a few notifications are handed to the stack at a time for each host, and the rest wait in
+ * these queues until the stack reports them sent. Every queued report is stamped with a sequence
+ * number shared by all report types, and the oldest report across the queues is always sent next,
+ * so a host sees a modifier press, a click and the modifier release in the order they happened.
+ *
+ * If a host falls far enough behind to fill a queue, the newest two reports of that type with no
+ * report of another type queued between them are collapsed into one, which only skips a state in
+ * between. If there are no such reports, the sender waits for the queue to drain, so congestion
+ * adds latency without reordering reports or losing the final state.
+ */
+struct hog_profile_queue {
+    uint8_t *reports;
+    uint32_t *sequences;
+    uint32_t head;
+    uint32_t count;
+    // Set while the head is being handed to the stack, and cleared if newer state is collapsed into
+    // it meanwhile, so the head is only popped if what was sent is still all it holds.
+    bool sending;
+};
 
-        bt_conn_unref(conn);
+struct hog_report_queue {
+    const char *name;
+    uint16_t attr_index;
+    size_t report_size;
+    uint32_t max_reports;
+    uint8_t *buffer;
+    uint32_t *sequence_buffer;
+    // Merges a newer report into an older one. If NULL, the newer report replaces it.
+    void (*collapse)(uint8_t *report, const uint8_t *newer);
+    struct hog_profile_queue profiles[ZMK_BLE_PROFILE_COUNT];
+};
+
+// A report is only popped once its notification was handed to the stack, so every queued report,
+// including the head, can still be collapsed. Collapsing into a head that is being sent keeps it
+// queued, so the collapsed state is sent after it.
+#define HOG_REPORT_QUEUE_DEFINE(_name, _label, _attr_index, _report_type, _max_reports,            \
+                                _collapse)                                                         \
+    static uint8_t _name##_buffer[ZMK_BLE_PROFILE_COUNT][sizeof(_report_type) * (_max_reports)];   \
+    static uint32_t _name##_sequence_buffer[ZMK_BLE_PROFILE_COUNT][(_max_reports)];                \
+    static struct hog_report_queue _name = {                                                       \
+        .name = _label,                                                                            \
+        .attr_index = _attr_index,                                                                 \
+        .report_size = sizeof(_report_type),                                                       \
+        .max_reports = _max_reports,                                                               \
+        .buffer = (uint8_t *)_name##_buffer,                                                       \
+        .sequence_buffer = (uint32_t *)_name##_sequence_buffer,                                    \
+        .collapse = _collapse,                                                                     \
     }
+
+HOG_REPORT_QUEUE_DEFINE(keyboard_queue, "Keyboard", 5, struct zmk_hid_keyboard_report_body,
+                        CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE, NULL);
+
+HOG_REPORT_QUEUE_DEFINE(consumer_queue, "Consumer", 9, struct zmk_hid_consumer_report_body,
+                        CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE, NULL);
+
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+HOG_REPORT_QUEUE_DEFINE(keyboard_hkro_queue, "Keyboard HKRO", HOG_KEYBOARD_HKRO_ATTR_INDEX,
+                        struct zmk_hid_keyboard_hkro_report_body,
+                        CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE, NULL);
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+
+// Mouse reports carry relative motion, so collapsing them has to add the motion up.
+static void collapse_mouse_report(uint8_t *report, const uint8_t *newer) {
+    struct zmk_hid_mouse_report_body *body = (struct zmk_hid_mouse_report_body *)report;
+    const struct zmk_hid_mouse_report_body *new_body =
+        (const struct zmk_hid_mouse_report_body *)newer;
+
+    body->buttons = new_body->buttons;
+    body->d_x = CLAMP(body->d_x + new_body->d_x, INT16_MIN, INT16_MAX);
+    body->d_y = CLAMP(body->d_y + new_body->d_y, INT16_MIN, INT16_MAX);
+    body->d_scroll_y = CLAMP(body->d_scroll_y + new_body->d_scroll_y, INT16_MIN, INT16_MAX);
+    body->d_scroll_x = CLAMP(body->d_scroll_x + new_body->d_scroll_x, INT16_MIN, INT16_MAX);
 }
 
-K_WORK_DEFINE(hog_keyboard_work, send_keyboard_report_callback);
+HOG_REPORT_QUEUE_DEFINE(mouse_queue, "Mouse", 13, struct zmk_hid_mouse_report_body,
+                        CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE, collapse_mouse_report);
 
-int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_keyboard_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Keyboard message queue full, popping first message and queueing again");
-            struct zmk_hid_keyboard_report_body discarded_report;
-            k_msgq_get(&zmk_hog_keyboard_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_keyboard_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue keyboard report to send (%d)", err);
-            return err;
-        }
-    }
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
-    k_work_submit_to_queue(&hog_work_q, &hog_keyboard_work);
+static struct hog_report_queue *const report_queues[] = {
+    &keyboard_queue,
+    &consumer_queue,
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    &keyboard_hkro_queue,
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    &mouse_queue,
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
 
-    return 0;
+// How long to wait before retrying when the stack has no buffer for a notification.
+#define HOG_RETRY_DELAY_MS 10
+
+// How long to wait for a full queue to drain before collapsing reports even if that reorders them.
+#define HOG_QUEUE_FULL_TIMEOUT_MS 100
+
+enum hog_push_result {
+    HOG_PUSH_QUEUED,
+    HOG_PUSH_COLLAPSED,
+    HOG_PUSH_FULL,
 };
 
-K_MSGQ_DEFINE(zmk_hog_consumer_msgq, sizeof(struct zmk_hid_consumer_report_body),
-              CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE, 4);
+static struct k_spinlock queue_lock;
+static uint32_t next_sequence;
+static atomic_t in_flight[ZMK_BLE_PROFILE_COUNT];
 
-void send_consumer_report_callback(struct k_work *work) {
-    struct zmk_hid_consumer_report_body report;
+static K_SEM_DEFINE(queue_space_sem, 0, 1);
 
-    while (k_msgq_get(&zmk_hog_consumer_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
+static void send_reports_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(send_reports_work, send_reports_callback);
+
+// Sequence numbers wrap around, so they're compared by their difference.
+static bool sequence_before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+static uint8_t *queue_report(const struct hog_report_queue *queue,
+                             const struct hog_profile_queue *pq, uint32_t index) {
+    return &pq->reports[((pq->head + index) % queue->max_reports) * queue->report_size];
+}
+
+static uint32_t *queue_sequence(const struct hog_report_queue *queue,
+                                const struct hog_profile_queue *pq, uint32_t index) {
+    return &pq->sequences[(pq->head + index) % queue->max_reports];
+}
+
+static void collapse_report(const struct hog_report_queue *queue, uint8_t *report,
+                            const uint8_t *newer) {
+    if (queue->collapse) {
+        queue->collapse(report, newer);
+    } else {
+        memcpy(report, newer, queue->report_size);
+    }
+}
+
+// Returns true if a report of another type was queued for the profile between two sequences.
+static bool other_report_between(const struct hog_report_queue *queue, uint8_t profile,
+                                 uint32_t after, uint32_t before) {
+    for (size_t i = 0; i < ARRAY_SIZE(report_queues); i++) {
+        const struct hog_report_queue *other = report_queues[i];
+        const struct hog_profile_queue *pq = &other->profiles[profile];
+
+        if (other == queue) {
+            continue;
         }
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[9],
-            .data = &report,
-            .len = sizeof(report),
-        };
+        for (uint32_t j = 0; j < pq->count; j++) {
+            const uint32_t sequence = *queue_sequence(other, pq, j);
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
+            if (sequence_before(after, sequence) && sequence_before(sequence, before)) {
+                return true;
+            }
         }
+    }
 
-        bt_conn_unref(conn);
+    return false;
+}
+
+static void queue_append(const struct hog_report_queue *queue, struct hog_profile_queue *pq,
+                         const uint8_t *report) {
+    memcpy(queue_report(queue, pq, pq->count), report, queue->report_size);
+    *queue_sequence(queue, pq, pq->count) = next_sequence++;
+    pq->count++;
+}
+
+static void queue_remove(const struct hog_report_queue *queue, struct hog_profile_queue *pq,
+                         uint32_t index) {
+    for (uint32_t i = index; i + 1 < pq->count; i++) {
+        memcpy(queue_report(queue, pq, i), queue_report(queue, pq, i + 1), queue->report_size);
+        *queue_sequence(queue, pq, i) = *queue_sequence(queue, pq, i + 1);
     }
-};
 
-K_WORK_DEFINE(hog_consumer_work, send_consumer_report_callback);
+    pq->count--;
+}
 
-int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_consumer_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_consumer_report_body discarded_report;
-            k_msgq_get(&zmk_hog_consumer_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_consumer_report(report);
+// Collapses queued reports to make room in a full queue without reordering them across report
+// types. If force is set, the report is collapsed into the newest queued one regardless.
+static enum hog_push_result queue_push(struct hog_report_queue *queue, uint8_t profile,
+                                       const uint8_t *report, bool force) {
+    struct hog_profile_queue *pq = &queue->profiles[profile];
+    enum hog_push_result result = HOG_PUSH_FULL;
+
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    if (pq->count < queue->max_reports) {
+        queue_append(queue, pq, report);
+        result = HOG_PUSH_QUEUED;
+    } else if (force || !other_report_between(queue, profile,
+                                              *queue_sequence(queue, pq, pq->count - 1),
+                                              next_sequence)) {
+        collapse_report(queue, queue_report(queue, pq, pq->count - 1), report);
+        pq->sending &= pq->count > 1;
+        result = HOG_PUSH_COLLAPSED;
+    } else if (pq->count >= 2) {
+        for (uint32_t i = pq->count - 1; i-- > 0;) {
+            if (!other_report_between(queue, profile, *queue_sequence(queue, pq, i),
+                                      *queue_sequence(queue, pq, i + 1))) {
+                collapse_report(queue, queue_report(queue, pq, i), queue_report(queue, pq, i + 1));
+                pq->sending &= i > 0;
+                queue_remove(queue, pq, i + 1);
+                queue_append(queue, pq, report);
+                result = HOG_PUSH_COLLAPSED;
+                break;
+            }
         }
-        default:
-            LOG_WRN("Failed to queue consumer report to send (%d)", err);
-            return err;
+    }
+
+    k_spin_unlock(&queue_lock, key);
+
+    return result;
+}
+
+// Copies the oldest report queued for the profile, across all report types.
+static struct hog_report_queue *queue_peek(uint8_t profile, uint8_t *report) {
+    struct hog_report_queue *oldest = NULL;
+    uint32_t oldest_sequence = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    for (size_t i = 0; i < ARRAY_SIZE(report_queues); i++) {
+        struct hog_report_queue *queue = report_queues[i];
+        const struct hog_profile_queue *pq = &queue->profiles[profile];
+
+        if (pq->count == 0) {
+            continue;
+        }
+
+        const uint32_t sequence = *queue_sequence(queue, pq, 0);
+        if (oldest == NULL || sequence_before(sequence, oldest_sequence)) {
+            oldest = queue;
+            oldest_sequence = sequence;
         }
     }
 
-    k_work_submit_to_queue(&hog_work_q, &hog_consumer_work);
+    if (oldest != NULL) {
+        memcpy(report, queue_report(oldest, &oldest->profiles[profile], 0), oldest->report_size);
+        oldest->profiles[profile].sending = true;
+    }
 
-    return 0;
-};
+    k_spin_unlock(&queue_lock, key);
 
-#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    return oldest;
+}
+
+static void queue_pop(struct hog_report_queue *queue, uint8_t profile) {
+    struct hog_profile_queue *pq = &queue->profiles[profile];
+
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    if (pq->count > 0 && pq->sending) {
+        pq->head = (pq->head + 1) % queue->max_reports;
+        pq->count--;
+    }
+    pq->sending = false;
+
+    k_spin_unlock(&queue_lock, key);
 
-K_MSGQ_DEFINE(zmk_hog_mouse_msgq, sizeof(struct zmk_hid_mouse_report_body),
-              CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE, 4);
+    k_sem_give(&queue_space_sem);
+}
+
+static bool queue_purge(uint8_t profile) {
+    bool purged = false;
+
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    for (size_t i = 0; i < ARRAY_SIZE(report_queues); i++) {
+        struct hog_profile_queue *pq = &report_queues[i]->profiles[profile];
+
+        purged |= pq->count > 0;
+        pq->head = 0;
+        pq->count = 0;
+        pq->sending = false;
+    }
 
-void send_mouse_report_callback(struct k_work *work) {
-    struct zmk_hid_mouse_report_body report;
-    while (k_msgq_get(&zmk_hog_mouse_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
+    k_spin_unlock(&queue_lock, key);
+
+    k_sem_give(&queue_space_sem);
+
+    return purged;
+}
+
+static void release_in_flight(uint8_t profile) {
+    atomic_val_t count;
+
+    do {
+        count = atomic_get(&in_flight[profile]);
+        if (count == 0) {
             return;
         }
+    } while (!atomic_cas(&in_flight[profile], count, count - 1));
+}
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[13],
-            .data = &report,
-            .len = sizeof(report),
-        };
+static void notify_complete(struct bt_conn *conn, void *user_data) {
+    release_in_flight(POINTER_TO_UINT(user_data));
+    k_work_reschedule_for_queue(&hog_work_q, &send_reports_work, K_NO_WAIT);
+}
+
+static int notify_report(struct bt_conn *conn, const struct hog_report_queue *queue,
+                         uint8_t profile, const uint8_t *report) {
+    struct bt_gatt_notify_params notify_params = {
+        .attr = &hog_svc.attrs[queue->attr_index],
+        .data = report,
+        .len = queue->report_size,
+        .func = notify_complete,
+        .user_data = UINT_TO_POINTER(profile),
+    };
+
+    atomic_inc(&in_flight[profile]);
+
+    int err = bt_gatt_notify_cb(conn, &notify_params);
+    if (err) {
+        release_in_flight(profile);
+    }
+
+    return err;
+}
+
+static struct bt_conn *connected_profile_conn(uint8_t profile) {
+    struct bt_conn *conn = zmk_ble_profile_conn(profile);
+    struct bt_conn_info info;
+
+    if (conn == NULL) {
+        return NULL;
+    }
+
+    bt_conn_get_info(conn, &info);
+    if (info.state != BT_CONN_STATE_CONNECTED) {
+        bt_conn_unref(conn);
+        return NULL;
+    }
+
+    return conn;
+}
+
+static void send_profile_reports(uint8_t profile) {
+    struct bt_conn *conn = connected_profile_conn(profile);
+    if (conn == NULL) {
+        if (queue_purge(profile)) {
+            LOG_WRN("Not sending, not connected to profile %d", profile);
+        }
+        return;
+    }
+
+    uint8_t report[sizeof(union hog_any_report)];
+    struct hog_report_queue *queue;
+
+    while (atomic_get(&in_flight[profile]) < CONFIG_ZMK_BLE_MAX_REPORTS_IN_FLIGHT &&
+           (queue = queue_peek(profile, report)) != NULL) {
+        int err = notify_report(conn, queue, profile, report);
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
         if (err == -EPERM) {
             bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
         }
 
-        bt_conn_unref(conn);
+        switch (err) {
+        case 0:
+            queue_pop(queue, profile);
+            continue;
+        case -EPERM:
+        case -ENOMEM:
+        case -ENOBUFS:
+        case -EAGAIN:
+            // Keep the report and try again once a notification completes, or after a delay if
+            // none is in flight to trigger that. Later reports wait behind it to keep their order.
+            LOG_DBG("Retrying %s report to profile %d (%d)", queue->name, profile, err);
+            if (atomic_get(&in_flight[profile]) == 0) {
+                k_work_schedule_for_queue(&hog_work_q, &send_reports_work,
+                                          K_MSEC(HOG_RETRY_DELAY_MS));
+            }
+            goto done;
+        default:
+            LOG_WRN("Dropping %s report to profile %d (%d)", queue->name, profile, err);
+            queue_pop(queue, profile);
+            break;
+        }
     }
-};
 
-K_WORK_DEFINE(hog_mouse_work, send_mouse_report_callback);
+done:
+    bt_conn_unref(conn);
+}
+
+static void send_reports_callback(struct k_work *work) {
+    for (int i = 0; i < ZMK_BLE_PROFILE_COUNT; i++) {
+        send_profile_reports(i);
+    }
+}
 
-int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_mouse_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_mouse_report_body discarded_report;
-            k_msgq_get(&zmk_hog_mouse_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_mouse_report(report);
+static void push_report(struct hog_report_queue *queue, uint8_t profile, const uint8_t *report) {
+    const int64_t deadline = k_uptime_get() + HOG_QUEUE_FULL_TIMEOUT_MS;
+    enum hog_push_result result;
+
+    while ((result = queue_push(queue, profile, report, false)) == HOG_PUSH_FULL) {
+        const int64_t remaining = deadline - k_uptime_get();
+        if (remaining <= 0) {
+            LOG_WRN("%s queue for profile %d is still full, collapsing reports out of order",
+                    queue->name, profile);
+            queue_push(queue, profile, report, true);
+            return;
         }
-        default:
-            LOG_WRN("Failed to queue mouse report to send (%d)", err);
-            return err;
+
+        k_work_reschedule_for_queue(&hog_work_q, &send_reports_work, K_NO_WAIT);
+        k_sem_take(&queue_space_sem, K_MSEC(remaining));
+    }
+
+    if (result == HOG_PUSH_COLLAPSED) {
+        LOG_DBG("%s queue for profile %d is full, collapsing reports", queue->name, profile);
+    }
+}
+
+static int send_report(struct hog_report_queue *queue, const void *report) {
+    const uint32_t output_profiles = zmk_ble_output_profiles();
+
+    for (int i = 0; i < ZMK_BLE_PROFILE_COUNT; i++) {
+        if (output_profiles & BIT(i)) {
+            push_report(queue, i, report);
         }
     }
 
-    k_work_submit_to_queue(&hog_work_q, &hog_mouse_work);
+    k_work_reschedule_for_queue(&hog_work_q, &send_reports_work, K_NO_WAIT);
 
     return 0;
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason) {
+    int profile = zmk_ble_profile_index(bt_conn_get_dst(conn));
+    if (profile < 0) {
+        return;
+    }
+
+    // Notifications still in flight went away with the connection.
+    atomic_set(&in_flight[profile], 0);
+    k_work_reschedule_for_queue(&hog_work_q, &send_reports_work, K_NO_WAIT);
+}
+
+static struct bt_conn_cb conn_callbacks = {
+    .disconnected = disconnected,
 };
+
+int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *report) {
+    return send_report(&keyboard_queue, report);
+}
+
+int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *report) {
+    return send_report(&consumer_queue, report);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+int zmk_hog_send_keyboard_hkro_report(struct zmk_hid_keyboard_hkro_report_body *report) {
+    return send_report(&keyboard_hkro_queue, report);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+
+int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *report) {
+    return send_report(&mouse_queue, report);
+}
+
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
 static int zmk_hog_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(report_queues); i++) {
+        struct hog_report_queue *queue = report_queues[i];
+        const size_t buffer_size = queue->report_size * queue->max_reports;
+
+        for (int j = 0; j < ZMK_BLE_PROFILE_COUNT; j++) {
+            queue->profiles[j].reports = &queue->buffer[j * buffer_size];
+            queue->profiles[j].sequences = &queue->sequence_buffer[j * queue->max_reports];
+        }
+    }
+
+    bt_conn_cb_register(&conn_callbacks);
+
     static const struct k_work_queue_config queue_config = {.name = "HID Over GATT Send Work"};
     k_work_queue_start(&hog_work_q, hog_q_stack, K_THREAD_STACK_SIZEOF(hog_q_stack),
                        CONFIG_ZMK_BLE_THREAD_PRIORITY, &queue_config);
@@ -12,6 +12,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <zmk/stdlib.h>
 #include <zmk/behavior.h>
+#include <zmk/benchmark.h>
 #include <zmk/keymap.h>
 #include <zmk/physical_layouts.h>
 #include <zmk/matrix.h>
@@ -70,8 +71,48 @@ static uint32_t zmk_keymap_active_behavior_layer[ZMK_KEYMAP_LEN];
 
 static uint8_t keymap_layer_orders[ZMK_KEYMAP_LAYERS_LEN];
 
+// Inverse of keymap_layer_orders, mapping each layer ID to its current index.
+static uint8_t keymap_layer_indexes[ZMK_KEYMAP_LAYERS_LEN];
+
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_RESOLVED_LAYER_CACHE)
+
+// The layer whose binding last handled each position, valid only for presses with the layer state
+// recorded in resolved_layer_ids_state. Cleared whenever the layer state, layer order or bindings
+// change, so lookups can start at that layer instead of walking down through transparent bindings.
+static zmk_keymap_layer_id_t resolved_layer_ids[ZMK_KEYMAP_LEN];
+static zmk_keymap_layers_state_t resolved_layer_ids_state;
+
+static void invalidate_resolved_layers(void) {
+    memset(resolved_layer_ids, ZMK_KEYMAP_LAYER_ID_INVAL, sizeof(resolved_layer_ids));
+    resolved_layer_ids_state = _zmk_keymap_layer_state;
+}
+
+static zmk_keymap_layer_id_t get_resolved_layer(uint32_t position,
+                                                zmk_keymap_layers_state_t state) {
+    if (state != resolved_layer_ids_state) {
+        return ZMK_KEYMAP_LAYER_ID_INVAL;
+    }
+
+    return resolved_layer_ids[position];
+}
+
+static void set_resolved_layer(uint32_t position, zmk_keymap_layers_state_t state,
+                               zmk_keymap_layer_id_t layer_id) {
+    if (state != resolved_layer_ids_state) {
+        return;
+    }
+
+    resolved_layer_ids[position] = layer_id;
+}
+
+#else
+
+static inline void invalidate_resolved_layers(void) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_RESOLVED_LAYER_CACHE)
+
 #define KEYMAP_VAR(_name, _opts, no_init)                                                          \
     static _opts struct zmk_behavior_binding _name[ZMK_KEYMAP_LAYERS_LEN][ZMK_KEYMAP_LEN] = {      \
         COND_CODE_0(                                                                               \
@@ -81,7 +122,10 @@ static uint8_t keymap_layer_orders[ZMK_KEYMAP_LAYERS_LEN];
                          (DT_INST_FOREACH_CHILD_STATUS_OKAY_SEP(0, TRANSFORMED_LAYER, (, ))))),    \
             (0))};
 
-KEYMAP_VAR(zmk_keymap, COND_CODE_1(IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE), (), (const)),
+KEYMAP_VAR(zmk_keymap,
+           COND_CODE_1(UTIL_OR(IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE),
+                               IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)),
+                       (), (const)),
            IS_ENABLED(CONFIG_ZMK_STUDIO))
 
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
@@ -108,6 +152,24 @@ static struct zmk_behavior_binding
 
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+
+static void resolve_binding_devices(void) {
+    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+        for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
+            zmk_behavior_resolve_binding_device(&zmk_keymap[l][k]);
+        }
+
+#if ZMK_KEYMAP_HAS_SENSORS
+        for (int s = 0; s < ZMK_KEYMAP_SENSORS_LEN; s++) {
+            zmk_behavior_resolve_binding_device(&zmk_sensor_keymap[l][s]);
+        }
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+
 #define ASSERT_LAYER_VAL(_layer, _fail_ret)                                                        \
     if ((_layer) >= ZMK_KEYMAP_LAYERS_LEN) {                                                       \
         return (_fail_ret);                                                                        \
@@ -116,13 +178,23 @@ static struct zmk_behavior_binding
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
 uint8_t map_layer_id_to_index(zmk_keymap_layer_id_t layer_id) {
+    if (layer_id >= ZMK_KEYMAP_LAYERS_LEN) {
+        return ZMK_KEYMAP_LAYER_ID_INVAL;
+    }
+
+    return keymap_layer_indexes[layer_id];
+}
+
+static void layer_orders_changed(void) {
+    memset(keymap_layer_indexes, ZMK_KEYMAP_LAYER_ID_INVAL, sizeof(keymap_layer_indexes));
+
     for (uint8_t i = 0; i < ZMK_KEYMAP_LAYERS_LEN; i++) {
-        if (keymap_layer_orders[i] == layer_id) {
-            return i;
+        if (keymap_layer_orders[i] < ZMK_KEYMAP_LAYERS_LEN) {
+            keymap_layer_indexes[keymap_layer_orders[i]] = i;
         }
     }
 
-    return ZMK_KEYMAP_LAYER_ID_INVAL;
+    invalidate_resolved_layers();
 }
 
 #define LAYER_INDEX_TO_ID(_layer) keymap_layer_orders[_layer]
@@ -151,6 +223,7 @@ static inline int set_layer_state(zmk_keymap_layer_id_t layer_id, bool state) {
     // Don't send state changes unless there was an actual change
     if (old_state != _zmk_keymap_layer_state) {
         LOG_DBG("layer_changed: layer %d state %d", layer_id, state);
+        invalidate_resolved_layers();
         ret = raise_layer_state_changed(layer_id, state);
         if (ret < 0) {
             LOG_WRN("Failed to raise layer state changed (%d)", ret);
@@ -290,6 +363,8 @@ int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint8_t
         return -EINVAL;
     }
 
+    zmk_behavior_resolve_binding_device(&binding);
+
     if (memcmp(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding)) == 0) {
         LOG_DBG("Not setting, no change to layer %d at index %d (%d)", layer_id, binding_idx,
                 storage_binding_idx);
@@ -302,6 +377,7 @@ int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint8_t
 
     // TODO: Need a mutex to protect access to the keymap data?
     memcpy(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding));
+    invalidate_resolved_layers();
 
     return 0;
 }
@@ -346,6 +422,8 @@ int zmk_keymap_move_layer(zmk_keymap_layer_index_t start_idx, zmk_keymap_layer_i
         keymap_layer_orders[dest_idx] = val;
     }
 
+    layer_orders_changed();
+
     return 0;
 }
 
@@ -364,6 +442,7 @@ int zmk_keymap_add_layer(void) {
         for (int candidate_id = 0; candidate_id < ZMK_KEYMAP_LAYERS_LEN; candidate_id++) {
             if (!(seen_layer_ids & BIT(candidate_id))) {
                 keymap_layer_orders[index] = candidate_id;
+                layer_orders_changed();
                 return index;
             }
         }
@@ -388,6 +467,7 @@ int zmk_keymap_remove_layer(zmk_keymap_layer_index_t index) {
     }
 
     keymap_layer_orders[ZMK_KEYMAP_LAYERS_LEN - 1] = ZMK_KEYMAP_LAYER_ID_INVAL;
+    layer_orders_changed();
 
     LOG_HEXDUMP_DBG(keymap_layer_orders, ZMK_KEYMAP_LAYERS_LEN, "Order");
 
@@ -403,6 +483,7 @@ int zmk_keymap_restore_layer(zmk_keymap_layer_id_t id, zmk_keymap_layer_index_t
     }
 
     keymap_layer_orders[at_index] = id;
+    layer_orders_changed();
 
     return 0;
 }
@@ -586,6 +667,8 @@ static void load_stock_keymap_layer_ordering() {
         keymap_layer_orders[i] = ZMK_KEYMAP_LAYER_ID_INVAL;
         i++;
     }
+
+    layer_orders_changed();
 }
 #endif
 
@@ -595,6 +678,12 @@ static void reload_from_stock_keymap(void) {
             zmk_keymap[l][k] = zmk_stock_keymap[l][k];
         }
     }
+
+    invalidate_resolved_layers();
+
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+    resolve_binding_devices();
+#endif
 }
 
 int zmk_keymap_discard_changes(void) {
@@ -701,6 +790,8 @@ int zmk_keymap_apply_position_state(uint8_t source, zmk_keymap_layer_id_t layer_
     LOG_DBG("layer_id: %d position: %d, binding name: %s", layer_id, position,
             binding->behavior_dev);
 
+    zmk_benchmark_mark(ZMK_BENCHMARK_STAGE_KEYMAP);
+
     return zmk_behavior_invoke_binding(binding, event, pressed);
 }
 
@@ -710,16 +801,25 @@ int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pr
         zmk_keymap_active_behavior_layer[position] = _zmk_keymap_layer_state;
     }
 
+    zmk_keymap_layers_state_t state = zmk_keymap_active_behavior_layer[position];
+    int start_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_RESOLVED_LAYER_CACHE)
+    zmk_keymap_layer_id_t resolved_id = get_resolved_layer(position, state);
+    if (resolved_id != ZMK_KEYMAP_LAYER_ID_INVAL) {
+        start_idx = LAYER_ID_TO_INDEX(resolved_id);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_RESOLVED_LAYER_CACHE)
+
     // We use int here to be sure we don't loop layer_idx back to UINT8_MAX
-    for (int layer_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
-         layer_idx >= LAYER_ID_TO_INDEX(_zmk_keymap_layer_default); layer_idx--) {
+    for (int layer_idx = start_idx; layer_idx >= LAYER_ID_TO_INDEX(_zmk_keymap_layer_default);
+         layer_idx--) {
         zmk_keymap_layer_id_t layer_id = LAYER_INDEX_TO_ID(layer_idx);
 
         if (layer_id == ZMK_KEYMAP_LAYER_ID_INVAL) {
             continue;
         }
-        if (zmk_keymap_layer_active_with_state(layer_id,
-                                               zmk_keymap_active_behavior_layer[position])) {
+        if (zmk_keymap_layer_active_with_state(layer_id, state)) {
             int ret =
                 zmk_keymap_apply_position_state(source, layer_id, position, pressed, timestamp);
             if (ret > 0) {
@@ -729,6 +829,9 @@ int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pr
                 LOG_DBG("Behavior returned error: %d", ret);
                 return ret;
             } else {
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_RESOLVED_LAYER_CACHE)
+                set_resolved_layer(position, state, layer_id);
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_RESOLVED_LAYER_CACHE)
                 return ret;
             }
         }
@@ -755,7 +858,7 @@ int zmk_keymap_sensor_event(uint8_t sensor_index,
         LOG_DBG("layer idx: %d, layer id: %d sensor_index: %d, binding name: %s", layer_idx,
                 layer_id, sensor_index, binding->behavior_dev);
 
-        const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+        const struct device *behavior = zmk_behavior_get_binding_device(binding);
         if (!behavior) {
             LOG_DBG("No behavior assigned to %d on layer %d", sensor_index, layer_id);
             continue;
@@ -922,6 +1025,7 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
 
         memcpy(keymap_layer_orders, settings_layer_orders,
                MIN(len, ARRAY_SIZE(settings_layer_orders)));
+        layer_orders_changed();
     }
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
@@ -947,6 +1051,12 @@ static int keymap_handle_commit(void) {
     }
 #endif
 
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+    resolve_binding_devices();
+#endif
+
+    invalidate_resolved_layers();
+
     return 0;
 }
 
@@ -956,11 +1066,15 @@ SETTINGS_STATIC_HANDLER_DEFINE(keymap, "keymap", NULL, keymap_handle_set, keymap
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
 
 int keymap_init(void) {
+    invalidate_resolved_layers();
+
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
     load_stock_keymap_layer_ordering();
 #endif
 #if IS_ENABLED(CONFIG_ZMK_STUDIO)
     reload_from_stock_keymap();
+#elif IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICE_CACHE_IN_BINDINGS)
+    resolve_binding_devices();
 #endif
 
     return 0;
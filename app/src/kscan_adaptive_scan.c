@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_kscan_gpio_matrix
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/activity.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/kscan_gpio_matrix.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define MATRIX_DEVICE(n) DEVICE_DT_INST_GET(n),
+
+static const struct device *const matrices[] = {DT_INST_FOREACH_STATUS_OKAY(MATRIX_DEVICE)};
+
+static int kscan_adaptive_scan_listener(const zmk_event_t *eh) {
+    const struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev == NULL) {
+        return -ENOTSUP;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(matrices); i++) {
+        int err = zmk_kscan_gpio_matrix_set_active(matrices[i], ev->state == ZMK_ACTIVITY_ACTIVE);
+        if (err < 0) {
+            LOG_WRN("Failed to update the scan activity of %s (%d)", matrices[i]->name, err);
+        }
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(kscan_adaptive_scan, kscan_adaptive_scan_listener);
+ZMK_SUBSCRIPTION(kscan_adaptive_scan, zmk_activity_state_changed);
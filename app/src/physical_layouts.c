@@ -18,6 +18,7 @@
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <zmk/benchmark.h>
 #include <zmk/matrix.h>
 #include <zmk/physical_layouts.h>
 #include <zmk/event_manager.h>
@@ -171,14 +172,72 @@ struct zmk_kscan_event {
     uint32_t row;
     uint32_t column;
     uint32_t state;
+    // Uptime in ticks when the kscan driver reported the event, so that time spent waiting in
+    // the queue doesn't skew the position event timestamp.
+    int64_t ticks;
 };
 
 static struct zmk_kscan_msg_processor {
     struct k_work work;
 } msg_processor;
 
-K_MSGQ_DEFINE(physical_layouts_kscan_msgq, sizeof(struct zmk_kscan_event),
-              CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE, 4);
+// Ring of kscan events for the processing work item, which is its only consumer. Producers are
+// serialized by a spinlock, since kscan callbacks may run in ISRs and, with more than one kscan
+// device or a driver reporting from several contexts, may overlap. The consumer only ever writes
+// the tail, so it reads without the lock. One slot is kept empty to tell a full ring apart from
+// an empty one.
+#define KSCAN_EVENT_RING_SLOTS (CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE + 1)
+
+static struct zmk_kscan_event kscan_event_ring[KSCAN_EVENT_RING_SLOTS];
+static atomic_t kscan_event_ring_head;
+static atomic_t kscan_event_ring_tail;
+static atomic_t kscan_event_ring_high_water;
+static atomic_t kscan_event_ring_dropped;
+static struct k_spinlock kscan_event_ring_put_lock;
+
+static bool kscan_event_ring_put(const struct zmk_kscan_event *ev) {
+    k_spinlock_key_t key = k_spin_lock(&kscan_event_ring_put_lock);
+
+    atomic_val_t head = atomic_get(&kscan_event_ring_head);
+    atomic_val_t tail = atomic_get(&kscan_event_ring_tail);
+    atomic_val_t next = (head + 1) % KSCAN_EVENT_RING_SLOTS;
+    bool put = next != tail;
+
+    if (put) {
+        kscan_event_ring[head] = *ev;
+        // Only publish the slot once it has been written.
+        atomic_set(&kscan_event_ring_head, next);
+
+        atomic_val_t used = (next - tail + KSCAN_EVENT_RING_SLOTS) % KSCAN_EVENT_RING_SLOTS;
+        if (used > atomic_get(&kscan_event_ring_high_water)) {
+            atomic_set(&kscan_event_ring_high_water, used);
+        }
+    } else {
+        atomic_inc(&kscan_event_ring_dropped);
+    }
+
+    k_spin_unlock(&kscan_event_ring_put_lock, key);
+    return put;
+}
+
+static bool kscan_event_ring_get(struct zmk_kscan_event *ev) {
+    atomic_val_t tail = atomic_get(&kscan_event_ring_tail);
+
+    if (tail == atomic_get(&kscan_event_ring_head)) {
+        return false;
+    }
+
+    *ev = kscan_event_ring[tail];
+    // Only hand the slot back to the producer once it has been read.
+    atomic_set(&kscan_event_ring_tail, (tail + 1) % KSCAN_EVENT_RING_SLOTS);
+
+    return true;
+}
+
+void zmk_physical_layouts_get_kscan_stats(struct zmk_physical_layouts_kscan_stats *stats) {
+    stats->high_water = atomic_get(&kscan_event_ring_high_water);
+    stats->dropped = atomic_get(&kscan_event_ring_dropped);
+}
 
 static void zmk_physical_layout_kscan_callback(const struct device *dev, uint32_t row,
                                                uint32_t column, bool pressed) {
@@ -186,19 +245,30 @@ static void zmk_physical_layout_kscan_callback(const struct device *dev, uint32_
         return;
     }
 
+    zmk_benchmark_mark(ZMK_BENCHMARK_STAGE_KSCAN);
+
     struct zmk_kscan_event ev = {
         .row = row,
         .column = column,
-        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED)};
+        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED),
+        .ticks = k_uptime_ticks()};
 
-    k_msgq_put(&physical_layouts_kscan_msgq, &ev, K_NO_WAIT);
+    kscan_event_ring_put(&ev);
     k_work_submit(&msg_processor.work);
 }
 
-static void zmk_physical_layouts_kscan_process_msgq(struct k_work *item) {
+static void zmk_physical_layouts_kscan_process_events(struct k_work *item) {
+    static atomic_val_t reported_dropped;
     struct zmk_kscan_event ev;
 
-    while (k_msgq_get(&physical_layouts_kscan_msgq, &ev, K_NO_WAIT) == 0) {
+    atomic_val_t dropped = atomic_get(&kscan_event_ring_dropped);
+    if (dropped != reported_dropped) {
+        LOG_WRN("Dropped %ld kscan events because the event queue was full",
+                (long)(dropped - reported_dropped));
+        reported_dropped = dropped;
+    }
+
+    while (kscan_event_ring_get(&ev)) {
         bool pressed = (ev.state == ZMK_KSCAN_EVENT_STATE_PRESSED);
         int32_t position = zmk_matrix_transform_row_column_to_position(active->matrix_transform,
                                                                        ev.row, ev.column);
@@ -211,11 +281,12 @@ static void zmk_physical_layouts_kscan_process_msgq(struct k_work *item) {
 
         LOG_DBG("Row: %d, col: %d, position: %d, pressed: %s", ev.row, ev.column, position,
                 (pressed ? "true" : "false"));
+        zmk_benchmark_mark(ZMK_BENCHMARK_STAGE_POSITION);
         raise_zmk_position_state_changed(
             (struct zmk_position_state_changed){.source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
                                                 .state = pressed,
                                                 .position = position,
-                                                .timestamp = k_uptime_get()});
+                                                .timestamp = k_ticks_to_ms_floor64(ev.ticks)});
     }
 }
 
@@ -467,7 +538,7 @@ SETTINGS_STATIC_HANDLER_DEFINE(physical_layouts, "physical_layouts", NULL,
 #endif // IS_ENABLED(CONFIG_SETTINGS)
 
 static int zmk_physical_layouts_init(void) {
-    k_work_init(&msg_processor.work, zmk_physical_layouts_kscan_process_msgq);
+    k_work_init(&msg_processor.work, zmk_physical_layouts_kscan_process_events);
 
 #if IS_ENABLED(CONFIG_PM_DEVICE)
     for (int l = 0; l < ARRAY_SIZE(layouts); l++) {
@@ -7,6 +7,7 @@
 #define DT_DRV_COMPAT zmk_input_split
 
 #include <zephyr/kernel.h>
+#include <zephyr/init.h>
 #include <zephyr/device.h>
 #include <zephyr/input/input.h>
 #include <drivers/input_processor.h>
@@ -15,6 +16,17 @@
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <zmk/split/transport/types.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) || CONFIG_ZMK_INPUT_SPLIT_FRAME_INTERVAL_MS > 0
+static const uint16_t frame_axis_codes[ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_COUNT] = {
+    [ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_X] = INPUT_REL_X,
+    [ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_Y] = INPUT_REL_Y,
+    [ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_WHEEL] = INPUT_REL_WHEEL,
+    [ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_HWHEEL] = INPUT_REL_HWHEEL,
+};
+#endif
+
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
 
 struct zis_entry {
@@ -38,13 +50,169 @@ int zmk_input_split_report_peripheral_event(uint8_t reg, uint8_t type, uint16_t
     return -ENODEV;
 }
 
+int zmk_input_split_report_peripheral_frame(uint8_t reg, uint8_t axes, const int16_t *values) {
+    for (size_t i = 0; i < ARRAY_SIZE(proxy_inputs); i++) {
+        if (reg != proxy_inputs[i].reg) {
+            continue;
+        }
+
+        // Replay the frame as one group, with sync set on its last axis.
+        for (size_t axis = 0; axis < ARRAY_SIZE(frame_axis_codes); axis++) {
+            if (!(axes & BIT(axis))) {
+                continue;
+            }
+
+            const bool sync = (axes >> (axis + 1)) == 0;
+            int ret = input_report(proxy_inputs[i].dev, INPUT_EV_REL, frame_axis_codes[axis],
+                                   values[axis], sync, K_NO_WAIT);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    return -ENODEV;
+}
+
 #define ZIS_INST(n)                                                                                \
     DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, NULL, POST_KERNEL,                                  \
                           CONFIG_ZMK_INPUT_SPLIT_INIT_PRIORITY, NULL);
 
 #else
 
-#include <zmk/split/bluetooth/service.h>
+#include <zmk/split/peripheral.h>
+
+#if CONFIG_ZMK_INPUT_SPLIT_FRAME_INTERVAL_MS > 0
+
+/*
+ * Relative motion is summed up and sent as one frame per interval instead of one event per
+ * sensor report, so a fast sensor can't flood the split link ahead of key events.
+ */
+struct zis_frame {
+    struct k_work_delayable work;
+    struct k_work_sync work_sync;
+    struct k_spinlock lock;
+    uint8_t reg;
+    uint8_t axes;
+    int32_t values[ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_COUNT];
+};
+
+#define ZIS_FRAME(n) {.reg = DT_INST_REG_ADDR(n)},
+
+static struct zis_frame frames[] = {DT_INST_FOREACH_STATUS_OKAY(ZIS_FRAME)};
+
+static void zis_frame_flush(struct zis_frame *frame) {
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_FRAME,
+        .data.input_frame = {.reg = frame->reg},
+    };
+
+    k_spinlock_key_t key = k_spin_lock(&frame->lock);
+    uint8_t remaining = 0;
+    for (size_t axis = 0; axis < ARRAY_SIZE(frame->values); axis++) {
+        if (!(frame->axes & BIT(axis))) {
+            continue;
+        }
+
+        // Anything that doesn't fit in this frame is carried over to the next one.
+        const int32_t value = CLAMP(frame->values[axis], INT16_MIN, INT16_MAX);
+        frame->values[axis] -= value;
+        if (frame->values[axis] != 0) {
+            remaining |= BIT(axis);
+        }
+
+        if (value != 0) {
+            ev.data.input_frame.axes |= BIT(axis);
+            ev.data.input_frame.values[axis] = value;
+        }
+    }
+    frame->axes = remaining;
+    k_spin_unlock(&frame->lock, key);
+
+    if (ev.data.input_frame.axes) {
+        zmk_split_peripheral_report_event(&ev);
+    }
+
+    if (remaining) {
+        k_work_schedule(&frame->work, K_MSEC(CONFIG_ZMK_INPUT_SPLIT_FRAME_INTERVAL_MS));
+    }
+}
+
+static void zis_frame_work_cb(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    zis_frame_flush(CONTAINER_OF(dwork, struct zis_frame, work));
+}
+
+static bool zis_frame_add(struct zis_frame *frame, const struct input_event *evt) {
+    if (evt->type != INPUT_EV_REL) {
+        return false;
+    }
+
+    for (size_t axis = 0; axis < ARRAY_SIZE(frame_axis_codes); axis++) {
+        if (evt->code != frame_axis_codes[axis]) {
+            continue;
+        }
+
+        k_spinlock_key_t key = k_spin_lock(&frame->lock);
+        frame->values[axis] += evt->value;
+        frame->axes |= BIT(axis);
+        k_spin_unlock(&frame->lock, key);
+
+        // Only the first motion since the last frame starts the timer.
+        k_work_schedule(&frame->work, K_MSEC(CONFIG_ZMK_INPUT_SPLIT_FRAME_INTERVAL_MS));
+        return true;
+    }
+
+    return false;
+}
+
+static void zis_frame_handle_event(struct zis_frame *frame, const struct input_event *evt) {
+    if (zis_frame_add(frame, evt)) {
+        return;
+    }
+
+    // Send any pending motion before e.g. a button event, so the two aren't reordered. A flush
+    // already running on the work queue has to finish sending its frame before this one starts.
+    k_work_cancel_delayable_sync(&frame->work, &frame->work_sync);
+    zis_frame_flush(frame);
+
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT,
+        .data.input_event = {.reg = frame->reg,
+                             .type = evt->type,
+                             .code = evt->code,
+                             .value = evt->value,
+                             .sync = evt->sync},
+    };
+    zmk_split_peripheral_report_event(&ev);
+}
+
+static int zis_frames_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(frames); i++) {
+        k_work_init_delayable(&frames[i].work, zis_frame_work_cb);
+    }
+
+    return 0;
+}
+
+SYS_INIT(zis_frames_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+#define ZIS_REPORT(n, evt) zis_frame_handle_event(&frames[n], evt)
+
+#else
+
+#define ZIS_REPORT(n, evt)                                                                         \
+    zmk_split_peripheral_report_event(&(struct zmk_split_transport_peripheral_event){              \
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT,                             \
+        .data.input_event = {.reg = DT_INST_REG_ADDR(n),                                           \
+                             .type = (evt)->type,                                                  \
+                             .code = (evt)->code,                                                  \
+                             .value = (evt)->value,                                                \
+                             .sync = (evt)->sync}})
+
+#endif // CONFIG_ZMK_INPUT_SPLIT_FRAME_INTERVAL_MS > 0
 
 #define ZIS_INST(n)                                                                                \
     static const struct zmk_input_processor_entry processors_##n[] =                               \
@@ -59,8 +227,7 @@ int zmk_input_split_report_peripheral_event(uint8_t reg, uint8_t type, uint16_t
             zmk_input_processor_handle_event(processors_##n[i].dev, evt, processors_##n[i].param1, \
                                              processors_##n[i].param2, NULL);                      \
         }                                                                                          \
-        zmk_split_bt_report_input(DT_INST_REG_ADDR(n), evt->type, evt->code, evt->value,           \
-                                  evt->sync);                                                      \
+        ZIS_REPORT(n, evt);                                                                        \
     }                                                                                              \
     INPUT_CALLBACK_DEFINE(DEVICE_DT_GET(DT_INST_PHANDLE(n, device)), split_input_handler_##n);
 
@@ -22,20 +22,32 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/stdlib.h>
 #include <zmk/ble.h>
 #include <zmk/behavior.h>
+#include <zmk/matrix.h>
 #include <zmk/sensors.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
+#include <zmk/split/central.h>
+#include <zmk/split/transport/central.h>
 #include <zmk/event_manager.h>
-#include <zmk/events/position_state_changed.h>
-#include <zmk/events/sensor_event.h>
 #include <zmk/events/battery_state_changed.h>
-#include <zmk/pointing/input_split.h>
 #include <zmk/hid_indicators_types.h>
 #include <zmk/physical_layouts.h>
 
 static int start_scanning(void);
 
-#define POSITION_STATE_DATA_LEN 16
+#define POSITION_STATE_DATA_LEN DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)
+
+// Peripherals relayed by the one in slot i get the source IDs i + n * the number of slots.
+#define RELAYED_PERIPHERALS CONFIG_ZMK_SPLIT_BLE_CENTRAL_RELAYED_PERIPHERALS
+#define SOURCE_FOR(slot, downstream) ((slot) + (downstream) * ZMK_SPLIT_BLE_PERIPHERAL_COUNT)
+
+struct peripheral_key_state {
+    uint8_t position_state[POSITION_STATE_DATA_LEN];
+    // Peripheral time of the last key event and our uptime when it arrived, used to stamp the
+    // releases of held keys on disconnect with the peripheral's current time.
+    uint32_t last_key_event_time;
+    int64_t last_key_event_uptime;
+};
 
 enum peripheral_slot_state {
     PERIPHERAL_SLOT_STATE_OPEN,
@@ -51,16 +63,21 @@ struct peripheral_slot {
     struct bt_gatt_subscribe_params sensor_subscribe_params;
     struct bt_gatt_discover_params sub_discover_params;
     uint16_t run_behavior_handle;
+    struct bt_gatt_read_params behavior_table_read_params;
+    char behavior_table[CONFIG_ZMK_SPLIT_BLE_CENTRAL_BEHAVIOR_TABLE_SIZE];
+    size_t behavior_table_len;
+    // -EAGAIN until the table has been read, then 0, or a negative error if the read failed.
+    int behavior_table_status;
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
     struct bt_gatt_subscribe_params batt_lvl_subscribe_params;
     struct bt_gatt_read_params batt_lvl_read_params;
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-    uint16_t update_hid_indicators;
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    uint16_t state_sync_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
     uint16_t selected_physical_layout_handle;
-    uint8_t position_state[POSITION_STATE_DATA_LEN];
-    uint8_t changed_positions[POSITION_STATE_DATA_LEN];
+    // Keys held on the peripheral itself, then on each peripheral it relays for.
+    struct peripheral_key_state key_states[1 + RELAYED_PERIPHERALS];
 };
 
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
@@ -134,18 +151,33 @@ static bool is_scanning = false;
 
 static const struct bt_uuid_128 split_service_uuid = BT_UUID_INIT_128(ZMK_SPLIT_BT_SERVICE_UUID);
 
-K_MSGQ_DEFINE(peripheral_event_msgq, sizeof(struct zmk_position_state_changed),
-              CONFIG_ZMK_SPLIT_BLE_CENTRAL_POSITION_QUEUE_SIZE, 4);
+extern const struct zmk_split_transport_central bt_central_transport;
 
-void peripheral_event_work_callback(struct k_work *work) {
-    struct zmk_position_state_changed ev;
-    while (k_msgq_get(&peripheral_event_msgq, &ev, K_NO_WAIT) == 0) {
-        LOG_DBG("Trigger key position state change for %d", ev.position);
-        raise_zmk_position_state_changed(ev);
-    }
+static void report_position_changed(uint8_t source, uint16_t position, bool pressed,
+                                    uint32_t timestamp) {
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+        .data.key_position_event = {.position = position,
+                                    .pressed = pressed ? 1 : 0,
+                                    .timestamp = timestamp},
+    };
+
+    zmk_split_transport_central_peripheral_event_handler(&bt_central_transport, source, ev);
 }
 
-K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
+static void report_resolved_key(uint8_t source, uint16_t position, bool pressed,
+                                uint32_t timestamp, uint32_t keycode, uint32_t layers) {
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT,
+        .data.keycode_event = {.position = position,
+                               .pressed = pressed ? 1 : 0,
+                               .timestamp = timestamp,
+                               .keycode = keycode,
+                               .layers = layers},
+    };
+
+    zmk_split_transport_central_peripheral_event_handler(&bt_central_transport, source, ev);
+}
 
 int peripheral_slot_index_for_conn(struct bt_conn *conn) {
     for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
@@ -185,34 +217,34 @@ int release_peripheral_slot(int index) {
     }
     slot->state = PERIPHERAL_SLOT_STATE_OPEN;
 
-    // Raise events releasing any active positions from this peripheral
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (slot->position_state[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                struct zmk_position_state_changed ev = {.source = index,
-                                                        .position = position,
-                                                        .state = false,
-                                                        .timestamp = k_uptime_get()};
-
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
+    // Raise events releasing any active positions from this peripheral and the ones it relays for
+    for (int d = 0; d < ARRAY_SIZE(slot->key_states); d++) {
+        struct peripheral_key_state *keys = &slot->key_states[d];
+        const uint32_t release_time =
+            keys->last_key_event_time + (uint32_t)(k_uptime_get() - keys->last_key_event_uptime);
+
+        for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
+            for (int j = 0; j < 8; j++) {
+                if (keys->position_state[i] & BIT(j)) {
+                    report_position_changed(SOURCE_FOR(index, d), (i * 8) + j, false,
+                                            release_time);
+                }
             }
         }
-    }
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->position_state[i] = 0U;
-        slot->changed_positions[i] = 0U;
+        memset(keys->position_state, 0, sizeof(keys->position_state));
     }
 
     // Clean up previously discovered handles;
     slot->subscribe_params.value_handle = 0;
     slot->run_behavior_handle = 0;
+    slot->behavior_table_read_params.single.handle = 0;
+    slot->behavior_table_len = 0;
+    slot->behavior_table_status = -EAGAIN;
     slot->selected_physical_layout_handle = 0;
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-    slot->update_hid_indicators = 0;
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    slot->state_sync_handle = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
 
     return 0;
 }
@@ -247,23 +279,11 @@ int confirm_peripheral_slot_conn(struct bt_conn *conn) {
     }
 
     peripherals[idx].state = PERIPHERAL_SLOT_STATE_CONNECTED;
+    zmk_split_transport_central_peripheral_connected(&bt_central_transport, idx);
     return 0;
 }
 
 #if ZMK_KEYMAP_HAS_SENSORS
-K_MSGQ_DEFINE(peripheral_sensor_event_msgq, sizeof(struct zmk_sensor_event),
-              CONFIG_ZMK_SPLIT_BLE_CENTRAL_POSITION_QUEUE_SIZE, 4);
-
-void peripheral_sensor_event_work_callback(struct k_work *work) {
-    struct zmk_sensor_event ev;
-    while (k_msgq_get(&peripheral_sensor_event_msgq, &ev, K_NO_WAIT) == 0) {
-        LOG_DBG("Trigger sensor change for %d", ev.sensor_index);
-        raise_zmk_sensor_event(ev);
-    }
-}
-
-K_WORK_DEFINE(peripheral_sensor_event_work, peripheral_sensor_event_work_callback);
-
 static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
                                                 struct bt_gatt_subscribe_params *params,
                                                 const void *data, uint16_t length) {
@@ -275,6 +295,12 @@ static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
 
     LOG_DBG("[SENSOR NOTIFICATION] data %p length %u", data, length);
 
+    const int slot_index = peripheral_slot_index_for_conn(conn);
+    if (slot_index < 0) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
     if (length < offsetof(struct sensor_event, channel_data)) {
         LOG_WRN("Ignoring sensor notify with insufficient data length (%d)", length);
         return BT_GATT_ITER_STOP;
@@ -282,15 +308,27 @@ static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
 
     struct sensor_event sensor_event;
     memcpy(&sensor_event, data, MIN(length, sizeof(sensor_event)));
-    struct zmk_sensor_event ev = {
-        .sensor_index = sensor_event.sensor_index,
-        .channel_data_size = MIN(sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
-        .timestamp = k_uptime_get()};
 
-    memcpy(ev.channel_data, sensor_event.channel_data,
-           sizeof(struct zmk_sensor_channel_data) * sensor_event.channel_data_size);
-    k_msgq_put(&peripheral_sensor_event_msgq, &ev, K_NO_WAIT);
-    k_work_submit(&peripheral_sensor_event_work);
+    if (sensor_event.downstream > RELAYED_PERIPHERALS) {
+        LOG_WRN("Ignoring sensor event relayed for downstream peripheral %d",
+                sensor_event.downstream);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT,
+        .data.sensor_event =
+            {
+                .sensor_index = sensor_event.sensor_index,
+                .channel_data_size =
+                    MIN(sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
+            },
+    };
+
+    memcpy(ev.data.sensor_event.channel_data, sensor_event.channel_data,
+           sizeof(struct zmk_sensor_channel_data) * ev.data.sensor_event.channel_data_size);
+    zmk_split_transport_central_peripheral_event_handler(
+        &bt_central_transport, SOURCE_FOR(slot_index, sensor_event.downstream), ev);
 
     return BT_GATT_ITER_CONTINUE;
 }
@@ -298,27 +336,6 @@ static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
 
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
 
-struct zmk_input_event_msg {
-    uint8_t reg;
-    struct zmk_split_input_event_payload payload;
-};
-
-K_MSGQ_DEFINE(peripheral_input_event_msgq, sizeof(struct zmk_input_event_msg), 5, 4);
-//   CONFIG_ZMK_SPLIT_BLE_CENTRAL_INPUT_QUEUE_SIZE, 4);
-
-void peripheral_input_event_work_callback(struct k_work *work) {
-    struct zmk_input_event_msg msg;
-    while (k_msgq_get(&peripheral_input_event_msgq, &msg, K_NO_WAIT) == 0) {
-        int ret = zmk_input_split_report_peripheral_event(
-            msg.reg, msg.payload.type, msg.payload.code, msg.payload.value, msg.payload.sync);
-        if (ret < 0) {
-            LOG_WRN("Failed to report peripheral event %d", ret);
-        }
-    }
-}
-
-K_WORK_DEFINE(input_event_work, peripheral_input_event_work_callback);
-
 static uint8_t peripheral_input_event_notify_cb(struct bt_conn *conn,
                                                 struct bt_gatt_subscribe_params *params,
                                                 const void *data, uint16_t length) {
@@ -330,31 +347,118 @@ static uint8_t peripheral_input_event_notify_cb(struct bt_conn *conn,
 
     LOG_DBG("[INPUT EVENT] data %p length %u", data, length);
 
-    if (length != sizeof(struct zmk_split_input_event_payload)) {
-        LOG_WRN("Ignoring input event notify with incorrect data length (%d)", length);
-        return BT_GATT_ITER_STOP;
+    const int slot_index = peripheral_slot_index_for_conn(conn);
+    if (slot_index < 0) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    struct peripheral_input_slot *slot = NULL;
+    for (size_t i = 0; i < ARRAY_SIZE(peripheral_input_slots); i++) {
+        if (&peripheral_input_slots[i].sub == params) {
+            slot = &peripheral_input_slots[i];
+            break;
+        }
+    }
+
+    if (!slot) {
+        return BT_GATT_ITER_CONTINUE;
     }
 
-    struct zmk_input_event_msg msg;
+    struct zmk_split_transport_peripheral_event ev;
+    uint8_t downstream;
 
-    memcpy(&msg.payload, data, MIN(length, sizeof(struct zmk_split_input_event_payload)));
+    if (length == sizeof(struct zmk_split_input_frame_payload)) {
+        struct zmk_split_input_frame_payload payload;
 
-    LOG_DBG("Got an input event with type %d, code %d, value %d, sync %d", msg.payload.type,
-            msg.payload.code, msg.payload.value, msg.payload.sync);
+        memcpy(&payload, data, sizeof(payload));
 
-    for (size_t i = 0; i < ARRAY_SIZE(peripheral_input_slots); i++) {
-        if (&peripheral_input_slots[i].sub == params) {
-            msg.reg = peripheral_input_slots[i].reg;
-            k_msgq_put(&peripheral_input_event_msgq, &msg, K_NO_WAIT);
-            k_work_submit(&input_event_work);
+        LOG_DBG("Got an input frame with axes 0x%02x", payload.axes);
+
+        downstream = payload.downstream;
+
+        ev = (struct zmk_split_transport_peripheral_event){
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_FRAME,
+            .data.input_frame =
+                {
+                    .reg = slot->reg,
+                    .axes = payload.axes,
+                },
+        };
+        for (size_t i = 0; i < ARRAY_SIZE(payload.values); i++) {
+            ev.data.input_frame.values[i] = sys_le16_to_cpu(payload.values[i]);
         }
+    } else if (length == sizeof(struct zmk_split_input_event_payload)) {
+        struct zmk_split_input_event_payload payload;
+
+        memcpy(&payload, data, sizeof(payload));
+
+        LOG_DBG("Got an input event with type %d, code %d, value %d, sync %d", payload.type,
+                payload.code, payload.value, payload.sync);
+
+        downstream = payload.downstream;
+
+        ev = (struct zmk_split_transport_peripheral_event){
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT,
+            .data.input_event =
+                {
+                    .reg = slot->reg,
+                    .type = payload.type,
+                    .code = payload.code,
+                    .value = payload.value,
+                    .sync = payload.sync,
+                },
+        };
+    } else {
+        LOG_WRN("Ignoring input event notify with incorrect data length (%d)", length);
+        return BT_GATT_ITER_STOP;
     }
 
+    if (downstream > RELAYED_PERIPHERALS) {
+        LOG_WRN("Ignoring input relayed for downstream peripheral %d", downstream);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    zmk_split_transport_central_peripheral_event_handler(&bt_central_transport,
+                                                         SOURCE_FOR(slot_index, downstream), ev);
+
     return BT_GATT_ITER_CONTINUE;
 }
 
 #endif
 
+static uint8_t split_central_resolved_key_notify(struct bt_conn *conn,
+                                                 struct peripheral_slot *slot, const void *data) {
+    const struct zmk_split_resolved_key_event_payload *payload = data;
+
+    if (payload->downstream > RELAYED_PERIPHERALS) {
+        LOG_WRN("Ignoring resolved key relayed for downstream peripheral %d", payload->downstream);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    const uint16_t position_state = sys_le16_to_cpu(payload->position_state);
+    const uint16_t position = position_state & ZMK_SPLIT_KEY_EVENT_POSITION_MASK;
+    const bool pressed = (position_state & ZMK_SPLIT_KEY_EVENT_PRESSED) != 0;
+    const uint32_t timestamp = sys_le32_to_cpu(payload->timestamp);
+
+    if (position >= ZMK_KEYMAP_LEN) {
+        LOG_WRN("Ignoring resolved key for out of range position %d", position);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    // Tracked like any other key, so it is released if the peripheral disconnects.
+    struct peripheral_key_state *keys = &slot->key_states[payload->downstream];
+    WRITE_BIT(keys->position_state[position / 8], position % 8, pressed);
+    keys->last_key_event_time = timestamp;
+    keys->last_key_event_uptime = k_uptime_get();
+
+    report_resolved_key(SOURCE_FOR(peripheral_slot_index_for_conn(conn), payload->downstream),
+                        position, pressed, timestamp, sys_le32_to_cpu(payload->keycode),
+                        sys_le32_to_cpu(payload->layers));
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
 static uint8_t split_central_notify_func(struct bt_conn *conn,
                                          struct bt_gatt_subscribe_params *params, const void *data,
                                          uint16_t length) {
@@ -373,27 +477,46 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
 
     LOG_DBG("[NOTIFICATION] data %p length %u", data, length);
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->changed_positions[i] = ((uint8_t *)data)[i] ^ slot->position_state[i];
-        slot->position_state[i] = ((uint8_t *)data)[i];
-        LOG_DBG("data: %d", slot->position_state[i]);
-    }
-
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (slot->changed_positions[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                bool pressed = slot->position_state[i] & BIT(j);
-                struct zmk_position_state_changed ev = {.source =
-                                                            peripheral_slot_index_for_conn(conn),
-                                                        .position = position,
-                                                        .state = pressed,
-                                                        .timestamp = k_uptime_get()};
-
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
-            }
+    if (length == sizeof(struct zmk_split_resolved_key_event_payload)) {
+        return split_central_resolved_key_notify(conn, slot, data);
+    }
+
+    const struct zmk_split_key_events_payload *payload = data;
+    const size_t header_len = sizeof(*payload);
+    const size_t event_len = sizeof(payload->events[0]);
+    if (length < header_len || (length - header_len) % event_len != 0) {
+        LOG_WRN("Ignoring key events notification with invalid length %u", length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    if (payload->downstream > RELAYED_PERIPHERALS) {
+        LOG_WRN("Ignoring key events relayed for downstream peripheral %d. Bump "
+                "CONFIG_ZMK_SPLIT_BLE_CENTRAL_RELAYED_PERIPHERALS.",
+                payload->downstream);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    struct peripheral_key_state *keys = &slot->key_states[payload->downstream];
+    const uint8_t source = SOURCE_FOR(peripheral_slot_index_for_conn(conn), payload->downstream);
+    uint32_t timestamp = sys_le32_to_cpu(payload->timestamp);
+
+    for (size_t i = 0; i < (length - header_len) / event_len; i++) {
+        const uint16_t position_state = sys_le16_to_cpu(payload->events[i].position_state);
+        const uint16_t position = position_state & ZMK_SPLIT_KEY_EVENT_POSITION_MASK;
+        const bool pressed = (position_state & ZMK_SPLIT_KEY_EVENT_PRESSED) != 0;
+
+        timestamp += payload->events[i].time_delta;
+
+        if (position >= ZMK_KEYMAP_LEN) {
+            LOG_WRN("Ignoring key event for out of range position %d", position);
+            continue;
         }
+
+        WRITE_BIT(keys->position_state[position / 8], position % 8, pressed);
+        keys->last_key_event_time = timestamp;
+        keys->last_key_event_uptime = k_uptime_get();
+
+        report_position_changed(source, position, pressed, timestamp);
     }
 
     return BT_GATT_ITER_CONTINUE;
@@ -503,6 +626,54 @@ static uint8_t split_central_battery_level_read_func(struct bt_conn *conn, uint8
 
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
 
+static uint8_t split_central_behavior_table_read_func(struct bt_conn *conn, uint8_t err,
+                                                      struct bt_gatt_read_params *params,
+                                                      const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (slot == NULL) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (err > 0) {
+        LOG_ERR("Error during reading peripheral behavior table: %d", err);
+        slot->behavior_table_status = -EIO;
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (!data) {
+        // Long reads call back once per chunk, then once more with no data when done.
+        if (slot->behavior_table_len == 0 ||
+            slot->behavior_table[slot->behavior_table_len - 1] != '\0') {
+            LOG_ERR("Peripheral behavior table is malformed");
+            slot->behavior_table_status = -EIO;
+            return BT_GATT_ITER_STOP;
+        }
+
+        LOG_DBG("Read peripheral behavior table of %zu bytes", slot->behavior_table_len);
+        slot->behavior_table_status = 0;
+
+        // Commands are only sent to peripherals with a behavior table, so this one missed any
+        // state changes up to now.
+        zmk_split_transport_central_request_state_sync(&bt_central_transport,
+                                                       peripheral_slot_index_for_conn(conn));
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (slot->behavior_table_len + length > sizeof(slot->behavior_table)) {
+        LOG_ERR("Peripheral behavior table is larger than %d bytes, so no behaviors can be run on "
+                "it. Bump CONFIG_ZMK_SPLIT_BLE_CENTRAL_BEHAVIOR_TABLE_SIZE.",
+                CONFIG_ZMK_SPLIT_BLE_CENTRAL_BEHAVIOR_TABLE_SIZE);
+        slot->behavior_table_status = -ENOMEM;
+        return BT_GATT_ITER_STOP;
+    }
+
+    memcpy(&slot->behavior_table[slot->behavior_table_len], data, length);
+    slot->behavior_table_len += length;
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
 static int split_central_subscribe(struct bt_conn *conn, struct bt_gatt_subscribe_params *params) {
     atomic_set(params->flags, BT_GATT_SUBSCRIBE_FLAG_NO_RESUB);
     int err = bt_gatt_subscribe(conn, params);
@@ -585,9 +756,9 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
     case BT_GATT_DISCOVER_CHARACTERISTIC: {
         const struct bt_uuid *chrc_uuid = ((struct bt_gatt_chrc *)attr->user_data)->uuid;
 
-        if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID)) ==
+        if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_KEY_EVENTS_UUID)) ==
             0) {
-            LOG_DBG("Found position state characteristic");
+            LOG_DBG("Found key events characteristic");
             slot->subscribe_params.disc_params = &slot->sub_discover_params;
             slot->subscribe_params.end_handle = slot->discover_params.end_handle;
             slot->subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
@@ -630,22 +801,34 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             }
 #endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
         } else if (bt_uuid_cmp(chrc_uuid,
-                               BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_UUID)) == 0) {
+                               BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIORS_UUID)) == 0) {
             LOG_DBG("Found run behavior handle");
             slot->discover_params.uuid = NULL;
             slot->discover_params.start_handle = attr->handle + 2;
             slot->run_behavior_handle = bt_gatt_attr_value_handle(attr);
+        } else if (bt_uuid_cmp(chrc_uuid,
+                               BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIOR_TABLE_UUID)) == 0) {
+            LOG_DBG("Found behavior table handle");
+            slot->behavior_table_len = 0;
+            slot->behavior_table_status = -EAGAIN;
+            slot->behavior_table_read_params.func = split_central_behavior_table_read_func;
+            slot->behavior_table_read_params.handle_count = 1;
+            slot->behavior_table_read_params.single.handle = bt_gatt_attr_value_handle(attr);
+            slot->behavior_table_read_params.single.offset = 0;
+            bt_gatt_read(conn, &slot->behavior_table_read_params);
         } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                                 BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SELECT_PHYS_LAYOUT_UUID))) {
             LOG_DBG("Found select physical layout handle");
             slot->selected_physical_layout_handle = bt_gatt_attr_value_handle(attr);
             k_work_submit(&update_peripherals_selected_layouts_work);
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
         } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
-                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_UPDATE_HID_INDICATORS_UUID))) {
-            LOG_DBG("Found update HID indicators handle");
-            slot->update_hid_indicators = bt_gatt_attr_value_handle(attr);
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_STATE_SYNC_UUID))) {
+            LOG_DBG("Found state sync handle");
+            slot->state_sync_handle = bt_gatt_attr_value_handle(attr);
+            zmk_split_transport_central_request_state_sync(&bt_central_transport,
+                                                           peripheral_slot_index_for_conn(conn));
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
         } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                                 BT_UUID_BAS_BATTERY_LEVEL)) {
@@ -712,15 +895,16 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
     }
 
     bool subscribed = slot->run_behavior_handle && slot->subscribe_params.value_handle &&
+                      slot->behavior_table_read_params.single.handle &&
                       slot->selected_physical_layout_handle;
 
 #if ZMK_KEYMAP_HAS_SENSORS
     subscribed = subscribed && slot->sensor_subscribe_params.value_handle;
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-    subscribed = subscribed && slot->update_hid_indicators;
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    subscribed = subscribed && slot->state_sync_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
     subscribed = subscribed && slot->batt_lvl_subscribe_params.value_handle;
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
@@ -1014,6 +1198,8 @@ static void split_central_security_changed(struct bt_conn *conn, bt_security_t l
     }
 
     k_work_submit(&update_peripherals_selected_layouts_work);
+    zmk_split_transport_central_request_state_sync(&bt_central_transport,
+                                                   peripheral_slot_index_for_conn(conn));
 }
 
 static struct bt_conn_cb conn_callbacks = {
@@ -1027,123 +1213,297 @@ K_THREAD_STACK_DEFINE(split_central_split_run_q_stack,
 
 struct k_work_q split_central_split_run_q;
 
-struct zmk_split_run_behavior_payload_wrapper {
+struct run_behavior_item {
     uint8_t source;
-    struct zmk_split_run_behavior_payload payload;
+    uint8_t len;
+    uint8_t data[ZMK_SPLIT_RUN_BEHAVIOR_MAX_SIZE];
 };
 
-K_MSGQ_DEFINE(zmk_split_central_split_run_msgq,
-              sizeof(struct zmk_split_run_behavior_payload_wrapper),
+K_MSGQ_DEFINE(zmk_split_central_split_run_msgq, sizeof(struct run_behavior_item),
               CONFIG_ZMK_SPLIT_BLE_CENTRAL_SPLIT_RUN_QUEUE_SIZE, 4);
 
+// How long to wait for room in the run behavior queue before failing the invocation.
+#define SPLIT_RUN_QUEUE_TIMEOUT_MS 100
+
+// An ATT write command takes 3 bytes for the opcode and handle.
+#define RUN_BEHAVIORS_WRITE_MAX_LEN (CONFIG_BT_L2CAP_TX_MTU - 3)
+
+struct run_behaviors_write {
+    uint8_t data[RUN_BEHAVIORS_WRITE_MAX_LEN];
+    size_t len;
+};
+
+// Only touched from the split run work queue.
+static struct run_behaviors_write run_behaviors_writes[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+
+// How long to wait before retrying a write the stack had no buffer for.
+#define RUN_BEHAVIORS_RETRY_DELAY_MS 10
+
+// Returns -EAGAIN if the write should be retried later, keeping the packed invocations.
+static int flush_run_behaviors_write(uint8_t source) {
+    struct run_behaviors_write *write = &run_behaviors_writes[source];
+    struct peripheral_slot *slot = &peripherals[source];
+
+    if (write->len == 0) {
+        return 0;
+    }
+
+    if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED || !slot->run_behavior_handle) {
+        LOG_ERR("Run behavior handle not found");
+        write->len = 0;
+        return -ENOTCONN;
+    }
+
+    int err = bt_gatt_write_without_response(slot->conn, slot->run_behavior_handle, write->data,
+                                             write->len, true);
+    switch (err) {
+    case 0:
+        write->len = 0;
+        return 0;
+    case -ENOMEM:
+    case -ENOBUFS:
+    case -EAGAIN:
+        // Dropping the batch could lose a release and leave a key stuck on the peripheral.
+        LOG_DBG("Retrying the behavior characteristic write (err %d)", err);
+        return -EAGAIN;
+    default:
+        LOG_ERR("Failed to write the behavior characteristic (err %d)", err);
+        write->len = 0;
+        return err;
+    }
+}
+
+void split_central_split_run_callback(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(split_central_split_run_work, split_central_split_run_callback);
+
 void split_central_split_run_callback(struct k_work *work) {
-    struct zmk_split_run_behavior_payload_wrapper payload_wrapper;
+    struct run_behavior_item item;
 
     LOG_DBG("");
 
-    while (k_msgq_get(&zmk_split_central_split_run_msgq, &payload_wrapper, K_NO_WAIT) == 0) {
-        if (peripherals[payload_wrapper.source].state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+    // Pack everything that queued up for a peripheral into as few writes as its MTU allows. An
+    // invocation is only taken off the queue once there is room for it, so while a write waits for
+    // the stack, later invocations wait in the queue and push back on whoever queues them.
+    while (k_msgq_peek(&zmk_split_central_split_run_msgq, &item) == 0) {
+        struct peripheral_slot *slot = &peripherals[item.source];
+        struct run_behaviors_write *write = &run_behaviors_writes[item.source];
+
+        if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED) {
             LOG_ERR("Source not connected");
+            k_msgq_get(&zmk_split_central_split_run_msgq, &item, K_NO_WAIT);
             continue;
         }
-        if (!peripherals[payload_wrapper.source].run_behavior_handle) {
-            LOG_ERR("Run behavior handle not found");
-            continue;
+
+        const size_t max_len = MIN(bt_gatt_get_mtu(slot->conn) - 3, sizeof(write->data));
+        if (write->len + item.len > max_len &&
+            flush_run_behaviors_write(item.source) == -EAGAIN) {
+            goto retry;
         }
 
-        int err = bt_gatt_write_without_response(
-            peripherals[payload_wrapper.source].conn,
-            peripherals[payload_wrapper.source].run_behavior_handle, &payload_wrapper.payload,
-            sizeof(struct zmk_split_run_behavior_payload), true);
+        k_msgq_get(&zmk_split_central_split_run_msgq, &item, K_NO_WAIT);
+        memcpy(&write->data[write->len], item.data, item.len);
+        write->len += item.len;
+    }
 
-        if (err) {
-            LOG_ERR("Failed to write the behavior characteristic (err %d)", err);
+    for (uint8_t i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        if (flush_run_behaviors_write(i) == -EAGAIN) {
+            goto retry;
         }
     }
+
+    return;
+
+retry:
+    k_work_schedule_for_queue(&split_central_split_run_q, &split_central_split_run_work,
+                              K_MSEC(RUN_BEHAVIORS_RETRY_DELAY_MS));
 }
 
-K_WORK_DEFINE(split_central_split_run_work, split_central_split_run_callback);
+static int find_peripheral_behavior_id(const struct peripheral_slot *slot, const char *name) {
+    if (slot->behavior_table_status < 0) {
+        return slot->behavior_table_status;
+    }
 
-static int
-split_bt_invoke_behavior_payload(struct zmk_split_run_behavior_payload_wrapper payload_wrapper) {
-    LOG_DBG("");
+    int id = 0;
+    for (size_t i = 0; i < slot->behavior_table_len; id++) {
+        const char *entry = &slot->behavior_table[i];
 
-    int err = k_msgq_put(&zmk_split_central_split_run_msgq, &payload_wrapper, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_split_run_behavior_payload_wrapper discarded_report;
-            k_msgq_get(&zmk_split_central_split_run_msgq, &discarded_report, K_NO_WAIT);
-            return split_bt_invoke_behavior_payload(payload_wrapper);
-        }
-        default:
-            LOG_WRN("Failed to queue behavior to send (%d)", err);
-            return err;
+        if (strncmp(entry, name, ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN - 1) == 0) {
+            return id <= UINT8_MAX ? id : -ENOTSUP;
         }
+
+        i += strnlen(entry, slot->behavior_table_len - i) + 1;
     }
 
-    k_work_submit_to_queue(&split_central_split_run_q, &split_central_split_run_work);
+    return -ENOENT;
+}
 
-    return 0;
-};
+static size_t put_run_behavior_param(uint8_t *data, uint32_t param, uint8_t size_code) {
+    const size_t size = zmk_split_run_behavior_param_size(size_code);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (param >> (8 * i)) & 0xFF;
+    }
+
+    return size;
+}
+
+static int split_bt_invoke_behavior(uint8_t source,
+                                    const struct zmk_split_transport_central_command *cmd) {
+    if (source >= SOURCE_FOR(0, 1 + RELAYED_PERIPHERALS)) {
+        return -EINVAL;
+    }
 
-int zmk_split_bt_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
-                                 struct zmk_behavior_binding_event event, bool state) {
-    struct zmk_split_run_behavior_payload payload = {.data = {
-                                                         .param1 = binding->param1,
-                                                         .param2 = binding->param2,
-                                                         .position = event.position,
-                                                         .source = event.source,
-                                                         .state = state ? 1 : 0,
-                                                     }};
-    const size_t payload_dev_size = sizeof(payload.behavior_dev);
-    if (strlcpy(payload.behavior_dev, binding->behavior_dev, payload_dev_size) >=
-        payload_dev_size) {
-        LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
-                binding->behavior_dev, payload.behavior_dev);
-    }
-
-    struct zmk_split_run_behavior_payload_wrapper wrapper = {.source = source, .payload = payload};
-    return split_bt_invoke_behavior_payload(wrapper);
+    // Relays look up the ID in their own table and forward the invocation by name.
+    const uint8_t slot = source % ZMK_SPLIT_BLE_PERIPHERAL_COUNT;
+    const uint8_t downstream = source / ZMK_SPLIT_BLE_PERIPHERAL_COUNT;
+
+    int id =
+        find_peripheral_behavior_id(&peripherals[slot], cmd->data.invoke_behavior.behavior_dev);
+    if (id < 0) {
+        LOG_ERR("Failed to find behavior %s on peripheral %d (%d)",
+                cmd->data.invoke_behavior.behavior_dev, source, id);
+        return id;
+    }
+
+    const uint32_t param1 = cmd->data.invoke_behavior.param1;
+    const uint32_t param2 = cmd->data.invoke_behavior.param2;
+    const uint8_t param1_size_code = zmk_split_run_behavior_param_size_code(param1);
+    const uint8_t param2_size_code = zmk_split_run_behavior_param_size_code(param2);
+
+    struct zmk_split_run_behavior_header header = {
+        .behavior_id = id,
+        .position = cmd->data.invoke_behavior.position,
+        .source = cmd->data.invoke_behavior.event_source,
+        .flags = (cmd->data.invoke_behavior.state ? ZMK_SPLIT_RUN_BEHAVIOR_PRESSED : 0) |
+                 (param1_size_code << ZMK_SPLIT_RUN_BEHAVIOR_PARAM1_SIZE_SHIFT) |
+                 (param2_size_code << ZMK_SPLIT_RUN_BEHAVIOR_PARAM2_SIZE_SHIFT) |
+                 (downstream << ZMK_SPLIT_RUN_BEHAVIOR_DOWNSTREAM_SHIFT),
+    };
+
+    struct run_behavior_item item = {.source = slot};
+    memcpy(item.data, &header, sizeof(header));
+    item.len = sizeof(header);
+    item.len += put_run_behavior_param(&item.data[item.len], param1, param1_size_code);
+    item.len += put_run_behavior_param(&item.data[item.len], param2, param2_size_code);
+
+    // Wait for room rather than dropping an older invocation, since losing a release would leave
+    // the behavior stuck on the peripheral. The queue drains on its own work queue, so this only
+    // times out if that has stalled, and the caller then sees the invocation fail.
+    int err = k_msgq_put(&zmk_split_central_split_run_msgq, &item,
+                         K_MSEC(SPLIT_RUN_QUEUE_TIMEOUT_MS));
+    if (err) {
+        LOG_ERR("Failed to queue behavior %s for peripheral %d (%d)",
+                cmd->data.invoke_behavior.behavior_dev, source, err);
+        return err;
+    }
+
+    k_work_schedule_for_queue(&split_central_split_run_q, &split_central_split_run_work, K_NO_WAIT);
+
+    return 0;
 }
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
 
-static zmk_hid_indicators_t hid_indicators = 0;
+// State waiting to be written to each peripheral. Fields changed again before the write are
+// merged, so only the latest values are sent.
+static struct zmk_split_transport_state_sync pending_state_syncs[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+static struct k_spinlock state_sync_lock;
 
-static void split_central_update_indicators_callback(struct k_work *work) {
-    zmk_hid_indicators_t indicators = hid_indicators;
+static void split_central_state_sync_callback(struct k_work *work) {
     for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
-        if (peripherals[i].state != PERIPHERAL_SLOT_STATE_CONNECTED) {
-            continue;
-        }
+        k_spinlock_key_t key = k_spin_lock(&state_sync_lock);
+        const struct zmk_split_transport_state_sync state = pending_state_syncs[i];
+        pending_state_syncs[i].fields = 0;
+        k_spin_unlock(&state_sync_lock, key);
 
-        if (peripherals[i].update_hid_indicators == 0) {
-            // It appears that sometimes the peripheral is considered connected
-            // before the GATT characteristics have been discovered. If this is
-            // the case, the update_hid_indicators handle will not yet be set.
+        if (state.fields == 0 || peripherals[i].state != PERIPHERAL_SLOT_STATE_CONNECTED ||
+            !peripherals[i].state_sync_handle) {
             continue;
         }
 
-        int err = bt_gatt_write_without_response(peripherals[i].conn,
-                                                 peripherals[i].update_hid_indicators, &indicators,
-                                                 sizeof(indicators), true);
+        uint8_t buf[ZMK_SPLIT_STATE_SYNC_PAYLOAD_MAX_SIZE];
+        const size_t len = zmk_split_state_sync_encode(&state, buf);
 
+        int err = bt_gatt_write_without_response(peripherals[i].conn,
+                                                 peripherals[i].state_sync_handle, buf, len, true);
         if (err) {
-            LOG_ERR("Failed to write HID indicator characteristic (err %d)", err);
+            LOG_ERR("Failed to write state sync characteristic (err %d)", err);
+            zmk_split_transport_central_request_state_sync(&bt_central_transport, i);
         }
     }
 }
 
-static K_WORK_DEFINE(split_central_update_indicators, split_central_update_indicators_callback);
+static K_WORK_DEFINE(split_central_state_sync_work, split_central_state_sync_callback);
+
+static int split_bt_state_sync(uint8_t source, const struct zmk_split_transport_state_sync *state) {
+    struct peripheral_slot *slot = &peripherals[source];
 
-int zmk_split_bt_update_hid_indicator(zmk_hid_indicators_t indicators) {
-    hid_indicators = indicators;
-    return k_work_submit_to_queue(&split_central_split_run_q, &split_central_update_indicators);
+    // Discovery and pairing finishing both ask for a full sync, so nothing is lost by refusing.
+    if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED || !slot->state_sync_handle ||
+        bt_conn_get_security(slot->conn) < BT_SECURITY_L2) {
+        return -EAGAIN;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&state_sync_lock);
+    struct zmk_split_transport_state_sync *pending = &pending_state_syncs[source];
+    const uint8_t fields = pending->fields | state->fields;
+    *pending = *state;
+    pending->fields = fields;
+    k_spin_unlock(&state_sync_lock, key);
+
+    return k_work_submit_to_queue(&split_central_split_run_q, &split_central_state_sync_work) < 0
+               ? -EIO
+               : 0;
 }
 
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+static int split_bt_send_command(uint8_t source, struct zmk_split_transport_central_command cmd) {
+    // Relays pass layout and indicator changes on to their downstream peripherals themselves.
+    if (source >= ZMK_SPLIT_BLE_PERIPHERAL_COUNT &&
+        cmd.type != ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR) {
+        return 0;
+    }
+
+    switch (cmd.type) {
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR:
+        return split_bt_invoke_behavior(source, &cmd);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
+        // The layout is written to every peripheral, reading the current selection when sent.
+        k_work_submit(&update_peripherals_selected_layouts_work);
+        return 0;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_STATE_SYNC:
+        return split_bt_state_sync(source, &cmd.data.state_sync);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static int split_bt_get_available_source_ids(uint8_t *sources) {
+    int count = 0;
+    for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        // Until its behavior table has been read, a peripheral can't run behaviors.
+        if (peripherals[i].state != PERIPHERAL_SLOT_STATE_CONNECTED ||
+            peripherals[i].behavior_table_status == -EAGAIN) {
+            continue;
+        }
+
+        for (int d = 0; d <= RELAYED_PERIPHERALS; d++) {
+            sources[count++] = SOURCE_FOR(i, d);
+        }
+    }
+
+    return count;
+}
+
+static const struct zmk_split_transport_central_api bt_central_api = {
+    .send_command = split_bt_send_command,
+    .get_available_source_ids = split_bt_get_available_source_ids,
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(bt_central_transport, &bt_central_api);
 
 static int finish_init() {
     return IS_ENABLED(CONFIG_ZMK_BLE_CLEAR_BONDS_ON_START) ? 0 : start_scanning();
@@ -1175,14 +1535,4 @@ static int zmk_split_bt_central_init(void) {
 #endif // IS_ENABLED(CONFIG_SETTINGS)
 }
 
-SYS_INIT(zmk_split_bt_central_init, APPLICATION, CONFIG_ZMK_BLE_INIT_PRIORITY);
-
-static int zmk_split_bt_central_listener_cb(const zmk_event_t *eh) {
-    if (as_zmk_physical_layout_selection_changed(eh)) {
-        k_work_submit(&update_peripherals_selected_layouts_work);
-    }
-    return ZMK_EV_EVENT_BUBBLE;
-}
-
-ZMK_LISTENER(zmk_split_bt_central, zmk_split_bt_central_listener_cb);
-ZMK_SUBSCRIPTION(zmk_split_bt_central, zmk_physical_layout_selection_changed);
\ No newline at end of file
+SYS_INIT(zmk_split_bt_central_init, APPLICATION, CONFIG_ZMK_BLE_INIT_PRIORITY);
\ No newline at end of file
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/bluetooth/conn.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/activity.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+
+/*
+ * Picks the split connection parameters from how the keyboard is being used. Key presses from
+ * peripherals only wait for the next connection event, so the interval bounds their latency,
+ * while peripheral latency lets an idle peripheral skip events it has nothing to send in.
+ */
+enum conn_params_level {
+    CONN_PARAMS_IDLE,
+    CONN_PARAMS_ACTIVE,
+    CONN_PARAMS_BURST,
+};
+
+struct conn_params {
+    uint16_t interval;
+    uint16_t latency;
+};
+
+static const struct conn_params levels[] = {
+    [CONN_PARAMS_IDLE] = {CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_IDLE_INT,
+                          CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_IDLE_LATENCY},
+    [CONN_PARAMS_ACTIVE] = {CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_ACTIVE_INT,
+                            CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_ACTIVE_LATENCY},
+    [CONN_PARAMS_BURST] = {CONFIG_ZMK_SPLIT_BLE_PREF_INT, CONFIG_ZMK_SPLIT_BLE_PREF_LATENCY},
+};
+
+// The supervision timeout has to cover at least two skipped connection events at every level.
+#define TIMEOUT_COVERS(interval, latency)                                                          \
+    (CONFIG_ZMK_SPLIT_BLE_PREF_TIMEOUT * 4 > (1 + (latency)) * (interval))
+
+BUILD_ASSERT(TIMEOUT_COVERS(CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_IDLE_INT,
+                            CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_IDLE_LATENCY),
+             "CONFIG_ZMK_SPLIT_BLE_PREF_TIMEOUT is too short for the idle connection parameters");
+BUILD_ASSERT(TIMEOUT_COVERS(CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_ACTIVE_INT,
+                            CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_ACTIVE_LATENCY),
+             "CONFIG_ZMK_SPLIT_BLE_PREF_TIMEOUT is too short for the active connection parameters");
+
+static enum conn_params_level current_level = CONN_PARAMS_BURST;
+static bool bursting;
+
+// Times of the most recent key presses, oldest first once the ring has wrapped.
+static int64_t press_times[CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_BURST_PRESSES];
+static uint8_t press_times_next;
+
+static void update_conn_params(struct bt_conn *conn, void *data) {
+    const struct conn_params *params = data;
+    struct bt_conn_info info;
+
+    // Only our connections to split peripherals are in the central role.
+    if (bt_conn_get_info(conn, &info) < 0 || info.role != BT_CONN_ROLE_CENTRAL ||
+        info.state != BT_CONN_STATE_CONNECTED) {
+        return;
+    }
+
+    if (info.le.interval == params->interval && info.le.latency == params->latency) {
+        return;
+    }
+
+    int err = bt_conn_le_param_update(
+        conn, BT_LE_CONN_PARAM(params->interval, params->interval, params->latency,
+                               CONFIG_ZMK_SPLIT_BLE_PREF_TIMEOUT));
+    if (err < 0) {
+        LOG_WRN("Failed to update split connection parameters (err %d)", err);
+    }
+}
+
+static void apply_level(void) {
+    enum conn_params_level level;
+
+    if (zmk_activity_get_state() != ZMK_ACTIVITY_ACTIVE) {
+        level = CONN_PARAMS_IDLE;
+    } else if (bursting) {
+        level = CONN_PARAMS_BURST;
+    } else {
+        level = CONN_PARAMS_ACTIVE;
+    }
+
+    if (level == current_level) {
+        return;
+    }
+
+    LOG_DBG("Split connection parameters %d -> %d", current_level, level);
+    current_level = level;
+
+    bt_conn_foreach(BT_CONN_TYPE_LE, update_conn_params, (void *)&levels[level]);
+}
+
+static void burst_end_work_cb(struct k_work *work) {
+    bursting = false;
+    apply_level();
+}
+
+static K_WORK_DELAYABLE_DEFINE(burst_end_work, burst_end_work_cb);
+
+static void record_press(int64_t timestamp) {
+    press_times[press_times_next] = timestamp;
+    press_times_next = (press_times_next + 1) % ARRAY_SIZE(press_times);
+
+    // After the increment, the next slot holds the oldest of the recent presses.
+    const int64_t oldest = press_times[press_times_next];
+    if (oldest != 0 && timestamp - oldest <= CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_BURST_WINDOW_MS) {
+        bursting = true;
+    }
+
+    if (bursting) {
+        k_work_reschedule(&burst_end_work, K_MSEC(CONFIG_ZMK_SPLIT_BLE_ADAPTIVE_BURST_HOLD_MS));
+    }
+
+    apply_level();
+}
+
+static void connected(struct bt_conn *conn, uint8_t err) {
+    if (err) {
+        return;
+    }
+
+    // New connections start out with the burst parameters they were created with.
+    update_conn_params(conn, (void *)&levels[current_level]);
+}
+
+static struct bt_conn_cb conn_callbacks = {
+    .connected = connected,
+};
+
+static int conn_params_listener(const zmk_event_t *eh) {
+    const struct zmk_position_state_changed *pos_ev = as_zmk_position_state_changed(eh);
+    if (pos_ev != NULL) {
+        if (pos_ev->state) {
+            record_press(pos_ev->timestamp);
+        }
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    if (as_zmk_activity_state_changed(eh) != NULL) {
+        apply_level();
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(split_central_conn_params, conn_params_listener);
+ZMK_SUBSCRIPTION(split_central_conn_params, zmk_position_state_changed);
+ZMK_SUBSCRIPTION(split_central_conn_params, zmk_activity_state_changed);
+
+static int split_central_conn_params_init(void) {
+    bt_conn_cb_register(&conn_callbacks);
+
+    return 0;
+}
+
+SYS_INIT(split_central_conn_params_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
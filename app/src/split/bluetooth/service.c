@@ -8,6 +8,7 @@
 #include <zephyr/types.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/iterable_sections.h>
 #include <zephyr/init.h>
 
 #include <zephyr/logging/log.h>
@@ -23,10 +24,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/physical_layouts.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
-
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-#include <zmk/events/hid_indicators_changed.h>
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#include <zmk/split/transport/peripheral.h>
 
 #include <zmk/events/sensor_event.h>
 #include <zmk/sensors.h>
@@ -45,59 +43,111 @@ static void split_svc_sensor_state_ccc(const struct bt_gatt_attr *attr, uint16_t
 }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
-#define POS_STATE_LEN 16
-
 static uint8_t num_of_positions = ZMK_KEYMAP_LEN;
-static uint8_t position_state[POS_STATE_LEN];
 
-static struct zmk_split_run_behavior_payload behavior_run_payload;
+extern const struct zmk_split_transport_peripheral bt_peripheral_transport;
+
+static ssize_t split_svc_behavior_table(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                        void *buf, uint16_t len, uint16_t offset) {
+    size_t table_offset = 0;
+    size_t copied = 0;
+
+    // Serialize the table on the fly, copying only the part of it the read asked for.
+    STRUCT_SECTION_FOREACH(zmk_behavior_ref, item) {
+        const char *name = item->device->name;
+        const size_t name_size = strlen(name) + 1;
+
+        if (offset < table_offset + name_size && copied < len) {
+            const size_t start = offset > table_offset ? offset - table_offset : 0;
+            const size_t count = MIN(name_size - start, len - copied);
+
+            memcpy((uint8_t *)buf + copied, name + start, count);
+            copied += count;
+        }
 
-static ssize_t split_svc_pos_state(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
-                                   void *buf, uint16_t len, uint16_t offset) {
-    return bt_gatt_attr_read(conn, attrs, buf, len, offset, &position_state,
-                             sizeof(position_state));
+        table_offset += name_size;
+    }
+
+    if (offset > table_offset) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    return copied;
 }
 
-static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
-                                      const void *buf, uint16_t len, uint16_t offset,
-                                      uint8_t flags) {
-    struct zmk_split_run_behavior_payload *payload = attrs->user_data;
-    uint16_t end_addr = offset + len;
+static uint32_t read_run_behavior_param(const uint8_t *data, size_t size) {
+    uint32_t param = 0;
+    for (size_t i = 0; i < size; i++) {
+        param |= (uint32_t)data[i] << (8 * i);
+    }
+
+    return param;
+}
+
+static ssize_t split_svc_run_behaviors(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                       const void *buf, uint16_t len, uint16_t offset,
+                                       uint8_t flags) {
+    const uint8_t *data = buf;
+    size_t pos = 0;
+    size_t behavior_count;
 
     LOG_DBG("offset %d len %d", offset, len);
 
-    if (end_addr > sizeof(struct zmk_split_run_behavior_payload)) {
+    if (offset != 0) {
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
     }
 
-    memcpy(payload + offset, buf, len);
-
-    // We run if:
-    // 1: We've gotten all the position/state/param data.
-    // 2: We have a null terminated string for the behavior device label.
-    const size_t behavior_dev_offset =
-        offsetof(struct zmk_split_run_behavior_payload, behavior_dev);
-    if ((end_addr > sizeof(struct zmk_split_run_behavior_data)) &&
-        payload->behavior_dev[end_addr - behavior_dev_offset - 1] == '\0') {
-        struct zmk_behavior_binding binding = {
-            .param1 = payload->data.param1,
-            .param2 = payload->data.param2,
-            .behavior_dev = payload->behavior_dev,
-        };
-        LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
-                binding.param2, payload->data.state);
-        struct zmk_behavior_binding_event event = {.position = payload->data.position,
-                                                   .timestamp = k_uptime_get()};
-        int err;
-        if (payload->data.state > 0) {
-            err = behavior_keymap_binding_pressed(&binding, event);
-        } else {
-            err = behavior_keymap_binding_released(&binding, event);
+    STRUCT_SECTION_COUNT(zmk_behavior_ref, &behavior_count);
+
+    while (pos < len) {
+        struct zmk_split_run_behavior_header header;
+        if (len - pos < sizeof(header)) {
+            return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
         }
 
-        if (err) {
-            LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+        memcpy(&header, data + pos, sizeof(header));
+        pos += sizeof(header);
+
+        const size_t param1_size = zmk_split_run_behavior_param_size(
+            (header.flags >> ZMK_SPLIT_RUN_BEHAVIOR_PARAM1_SIZE_SHIFT) &
+            ZMK_SPLIT_RUN_BEHAVIOR_PARAM_SIZE_MASK);
+        const size_t param2_size = zmk_split_run_behavior_param_size(
+            (header.flags >> ZMK_SPLIT_RUN_BEHAVIOR_PARAM2_SIZE_SHIFT) &
+            ZMK_SPLIT_RUN_BEHAVIOR_PARAM_SIZE_MASK);
+        if (len - pos < param1_size + param2_size) {
+            return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
         }
+
+        const uint32_t param1 = read_run_behavior_param(data + pos, param1_size);
+        pos += param1_size;
+        const uint32_t param2 = read_run_behavior_param(data + pos, param2_size);
+        pos += param2_size;
+
+        if (header.behavior_id >= behavior_count) {
+            LOG_WRN("Ignoring invocation of unknown behavior ID %d", header.behavior_id);
+            continue;
+        }
+
+        const struct zmk_behavior_ref *ref;
+        STRUCT_SECTION_GET(zmk_behavior_ref, header.behavior_id, &ref);
+
+        struct zmk_split_transport_central_command cmd = {
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
+            .downstream = (header.flags >> ZMK_SPLIT_RUN_BEHAVIOR_DOWNSTREAM_SHIFT) &
+                          ZMK_SPLIT_RUN_BEHAVIOR_DOWNSTREAM_MASK,
+            .data.invoke_behavior =
+                {
+                    .param1 = param1,
+                    .param2 = param2,
+                    .position = header.position,
+                    .event_source = header.source,
+                    .state = (header.flags & ZMK_SPLIT_RUN_BEHAVIOR_PRESSED) ? 1 : 0,
+                },
+        };
+        strlcpy(cmd.data.invoke_behavior.behavior_dev, ref->device->name,
+                sizeof(cmd.data.invoke_behavior.behavior_dev));
+
+        zmk_split_transport_peripheral_command_handler(&bt_peripheral_transport, cmd);
     }
 
     return len;
@@ -108,46 +158,38 @@ static ssize_t split_svc_num_of_positions(struct bt_conn *conn, const struct bt_
     return bt_gatt_attr_read(conn, attrs, buf, len, offset, attrs->user_data, sizeof(uint8_t));
 }
 
-static void split_svc_pos_state_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
+static void split_svc_key_events_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
     LOG_DBG("value %d", value);
 }
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
 
-static zmk_hid_indicators_t hid_indicators = 0;
-
-static void split_svc_update_indicators_callback(struct k_work *work) {
-    LOG_DBG("Raising HID indicators changed event: %x", hid_indicators);
-    raise_zmk_hid_indicators_changed(
-        (struct zmk_hid_indicators_changed){.indicators = hid_indicators});
-}
-
-static K_WORK_DEFINE(split_svc_update_indicators_work, split_svc_update_indicators_callback);
-
-static ssize_t split_svc_update_indicators(struct bt_conn *conn, const struct bt_gatt_attr *attr,
-                                           const void *buf, uint16_t len, uint16_t offset,
-                                           uint8_t flags) {
-    if (offset + len > sizeof(zmk_hid_indicators_t)) {
+static ssize_t split_svc_state_sync(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                    const void *buf, uint16_t len, uint16_t offset,
+                                    uint8_t flags) {
+    if (offset != 0) {
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
     }
 
-    memcpy((uint8_t *)&hid_indicators + offset, buf, len);
+    struct zmk_split_transport_central_command cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_STATE_SYNC,
+    };
+
+    int err = zmk_split_state_sync_decode(buf, len, &cmd.data.state_sync);
+    if (err == -ENOTSUP) {
+        LOG_WRN("Ignoring state sync version %d, expected %d", cmd.data.state_sync.version,
+                ZMK_SPLIT_TRANSPORT_STATE_SYNC_VERSION);
+        return len;
+    } else if (err < 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
 
-    k_work_submit(&split_svc_update_indicators_work);
+    zmk_split_transport_peripheral_command_handler(&bt_peripheral_transport, cmd);
 
     return len;
 }
 
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-
-static uint8_t selected_phys_layout = 0;
-
-static void split_svc_select_phys_layout_callback(struct k_work *work) {
-    LOG_DBG("Selecting physical layout after GATT write of %d", selected_phys_layout);
-    zmk_physical_layouts_select(selected_phys_layout);
-}
-
-static K_WORK_DEFINE(split_svc_select_phys_layout_work, split_svc_select_phys_layout_callback);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
 
 static ssize_t split_svc_select_phys_layout(struct bt_conn *conn, const struct bt_gatt_attr *attr,
                                             const void *buf, uint16_t len, uint16_t offset,
@@ -156,9 +198,14 @@ static ssize_t split_svc_select_phys_layout(struct bt_conn *conn, const struct b
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
     }
 
-    selected_phys_layout = *(uint8_t *)buf;
+    LOG_DBG("Physical layout %d selected by GATT write", *(uint8_t *)buf);
 
-    k_work_submit(&split_svc_select_phys_layout_work);
+    zmk_split_transport_peripheral_command_handler(
+        &bt_peripheral_transport,
+        (struct zmk_split_transport_central_command){
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT,
+            .data.set_physical_layout = {.layout_idx = *(uint8_t *)buf},
+        });
 
     return len;
 }
@@ -217,13 +264,12 @@ ssize_t bt_gatt_attr_read_input_split_cpf(struct bt_conn *conn, const struct bt_
 
 BT_GATT_SERVICE_DEFINE(
     split_svc, BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SERVICE_UUID)),
-    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID),
-                           BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT,
-                           split_svc_pos_state, NULL, &position_state),
-    BT_GATT_CCC(split_svc_pos_state_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
-    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_UUID),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_KEY_EVENTS_UUID),
+                           BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT, NULL, NULL, NULL),
+    BT_GATT_CCC(split_svc_key_events_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIORS_UUID),
                            BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
-                           split_svc_run_behavior, &behavior_run_payload),
+                           split_svc_run_behaviors, NULL),
     BT_GATT_DESCRIPTOR(BT_UUID_NUM_OF_DIGITALS, BT_GATT_PERM_READ, split_svc_num_of_positions, NULL,
                        &num_of_positions),
 #if ZMK_KEYMAP_HAS_SENSORS
@@ -232,12 +278,15 @@ BT_GATT_SERVICE_DEFINE(
                            split_svc_sensor_state, NULL, &last_sensor_event),
     BT_GATT_CCC(split_svc_sensor_state_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIOR_TABLE_UUID),
+                           BT_GATT_CHRC_READ, BT_GATT_PERM_READ_ENCRYPT, split_svc_behavior_table,
+                           NULL, NULL),
     DT_FOREACH_STATUS_OKAY(zmk_input_split, INPUT_SPLIT_CHARS)
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-        BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_UPDATE_HID_INDICATORS_UUID),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+        BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_STATE_SYNC_UUID),
                                BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
-                               split_svc_update_indicators, NULL),
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+                               split_svc_state_sync, NULL),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
     BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SELECT_PHYS_LAYOUT_UUID),
                            BT_GATT_CHRC_WRITE | BT_GATT_CHRC_READ,
                            BT_GATT_PERM_WRITE_ENCRYPT | BT_GATT_PERM_READ_ENCRYPT,
@@ -248,51 +297,130 @@ K_THREAD_STACK_DEFINE(service_q_stack, CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_STACK_SIZ
 
 struct k_work_q service_work_q;
 
-K_MSGQ_DEFINE(position_state_msgq, sizeof(char[POS_STATE_LEN]),
+struct key_event_item {
+    uint16_t position;
+    bool pressed;
+    uint8_t downstream;
+    uint32_t timestamp;
+    // Set for keys resolved with the peripheral's keymap, which are sent on their own.
+    bool resolved;
+    uint32_t keycode;
+    uint32_t layers;
+};
+
+K_MSGQ_DEFINE(key_event_msgq, sizeof(struct key_event_item),
               CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
 
-void send_position_state_callback(struct k_work *work) {
-    uint8_t state[POS_STATE_LEN];
+#define KEY_EVENTS_PAYLOAD_SIZE                                                                    \
+    (sizeof(struct zmk_split_key_events_payload) +                                                 \
+     CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_KEY_EVENT_BATCH_SIZE * sizeof(struct zmk_split_key_event))
 
-    while (k_msgq_get(&position_state_msgq, &state, K_NO_WAIT) == 0) {
-        int err = bt_gatt_notify(NULL, &split_svc.attrs[1], &state, sizeof(state));
-        if (err) {
-            LOG_DBG("Error notifying %d", err);
+// How long to wait before retrying when the stack has no buffer for a notification.
+#define KEY_EVENTS_RETRY_DELAY_MS 10
+
+/*
+ * The notification being sent. It's kept until the stack accepts it, so one that fails for lack of
+ * buffers is retried rather than lost, with the events queued after it waiting behind it.
+ */
+static uint8_t pending_buf[MAX(KEY_EVENTS_PAYLOAD_SIZE,
+                               sizeof(struct zmk_split_resolved_key_event_payload))];
+static size_t pending_len;
+
+static size_t build_key_events_notification(uint8_t *buf) {
+    struct zmk_split_key_events_payload *payload = (struct zmk_split_key_events_payload *)buf;
+    struct key_event_item item;
+
+    if (k_msgq_peek(&key_event_msgq, &item) != 0) {
+        return 0;
+    }
+
+    if (item.resolved) {
+        k_msgq_get(&key_event_msgq, &item, K_NO_WAIT);
+
+        struct zmk_split_resolved_key_event_payload resolved = {
+            .timestamp = sys_cpu_to_le32(item.timestamp),
+            .downstream = item.downstream,
+            .position_state =
+                sys_cpu_to_le16(item.position | (item.pressed ? ZMK_SPLIT_KEY_EVENT_PRESSED : 0)),
+            .keycode = sys_cpu_to_le32(item.keycode),
+            .layers = sys_cpu_to_le32(item.layers),
+        };
+
+        memcpy(buf, &resolved, sizeof(resolved));
+        return sizeof(resolved);
+    }
+
+    size_t count = 0;
+    uint32_t last_time = item.timestamp;
+    uint8_t downstream = item.downstream;
+
+    payload->timestamp = sys_cpu_to_le32(item.timestamp);
+    payload->downstream = downstream;
+
+    while (count < CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_KEY_EVENT_BATCH_SIZE &&
+           k_msgq_peek(&key_event_msgq, &item) == 0) {
+        uint32_t delta = item.timestamp - last_time;
+        if (delta > UINT8_MAX || item.downstream != downstream || item.resolved) {
+            break;
         }
+
+        k_msgq_get(&key_event_msgq, &item, K_NO_WAIT);
+
+        payload->events[count++] = (struct zmk_split_key_event){
+            .position_state =
+                sys_cpu_to_le16(item.position | (item.pressed ? ZMK_SPLIT_KEY_EVENT_PRESSED : 0)),
+            .time_delta = delta,
+        };
+        last_time = item.timestamp;
     }
-};
 
-K_WORK_DEFINE(service_position_notify_work, send_position_state_callback);
+    return sizeof(*payload) + count * sizeof(payload->events[0]);
+}
+
+void send_key_events_callback(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(service_key_events_notify_work, send_key_events_callback);
+
+void send_key_events_callback(struct k_work *work) {
+    // Everything that queued up while the previous notification was being sent goes out together.
+    while (pending_len > 0 || (pending_len = build_key_events_notification(pending_buf)) > 0) {
+        int err = bt_gatt_notify(NULL, &split_svc.attrs[1], pending_buf, pending_len);
 
-int send_position_state() {
-    int err = k_msgq_put(&position_state_msgq, position_state, K_MSEC(100));
-    if (err) {
         switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Position state message queue full, popping first message and queueing again");
-            uint8_t discarded_state[POS_STATE_LEN];
-            k_msgq_get(&position_state_msgq, &discarded_state, K_NO_WAIT);
-            return send_position_state();
-        }
+        case 0:
+            break;
+        case -ENOMEM:
+        case -ENOBUFS:
+        case -EAGAIN:
+            LOG_DBG("Retrying key events notification (%d)", err);
+            k_work_schedule_for_queue(&service_work_q, &service_key_events_notify_work,
+                                      K_MSEC(KEY_EVENTS_RETRY_DELAY_MS));
+            return;
         default:
-            LOG_WRN("Failed to queue position state to send (%d)", err);
-            return err;
+            LOG_WRN("Dropping key events notification (%d)", err);
+            break;
         }
+
+        pending_len = 0;
     }
+}
 
-    k_work_submit_to_queue(&service_work_q, &service_position_notify_work);
+static int queue_key_event(const struct key_event_item *item) {
+    if (item->position > ZMK_SPLIT_KEY_EVENT_POSITION_MASK) {
+        return -EINVAL;
+    }
 
-    return 0;
-}
+    // Unlike a full state snapshot, a change can't be dropped without leaving the central out of
+    // sync, so wait for room rather than discarding older events.
+    int err = k_msgq_put(&key_event_msgq, item, K_MSEC(100));
+    if (err) {
+        LOG_ERR("Failed to queue key event for position %d (%d)", item->position, err);
+        return err;
+    }
 
-int zmk_split_bt_position_pressed(uint8_t position) {
-    WRITE_BIT(position_state[position / 8], position % 8, true);
-    return send_position_state();
-}
+    k_work_schedule_for_queue(&service_work_q, &service_key_events_notify_work, K_NO_WAIT);
 
-int zmk_split_bt_position_released(uint8_t position) {
-    WRITE_BIT(position_state[position / 8], position % 8, false);
-    return send_position_state();
+    return 0;
 }
 
 #if ZMK_KEYMAP_HAS_SENSORS
@@ -332,15 +460,16 @@ int send_sensor_state(struct sensor_event ev) {
     return 0;
 }
 
-int zmk_split_bt_sensor_triggered(uint8_t sensor_index,
-                                  const struct zmk_sensor_channel_data channel_data[],
-                                  size_t channel_data_size) {
+static int split_bt_sensor_triggered(uint8_t downstream, uint8_t sensor_index,
+                                     const struct zmk_sensor_channel_data channel_data[],
+                                     size_t channel_data_size) {
     if (channel_data_size > ZMK_SENSOR_EVENT_MAX_CHANNELS) {
         return -EINVAL;
     }
 
-    struct sensor_event ev =
-        (struct sensor_event){.sensor_index = sensor_index, .channel_data_size = channel_data_size};
+    struct sensor_event ev = (struct sensor_event){.sensor_index = sensor_index,
+                                                   .downstream = downstream,
+                                                   .channel_data_size = channel_data_size};
     memcpy(ev.channel_data, channel_data,
            channel_data_size * sizeof(struct zmk_sensor_channel_data));
     return send_sensor_state(ev);
@@ -349,27 +478,102 @@ int zmk_split_bt_sensor_triggered(uint8_t sensor_index,
 
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
 
-int zmk_split_bt_report_input(uint8_t reg, uint8_t type, uint16_t code, int32_t value, bool sync) {
-
+static const struct bt_gatt_attr *input_attr_for_reg(uint8_t reg) {
     for (size_t i = 0; i < split_svc.attr_count; i++) {
         if (bt_uuid_cmp(split_svc.attrs[i].uuid,
                         BT_UUID_DECLARE_128(ZMK_SPLIT_BT_INPUT_EVENT_UUID)) == 0 &&
             (uint8_t)(uint32_t)split_svc.attrs[i + 2].user_data == reg) {
-            struct zmk_split_input_event_payload payload = {
-                .type = type,
-                .code = code,
-                .value = value,
-                .sync = sync ? 1 : 0,
-            };
-
-            return bt_gatt_notify(NULL, &split_svc.attrs[i], &payload, sizeof(payload));
+            return &split_svc.attrs[i];
         }
     }
-    return -ENODEV;
+
+    return NULL;
+}
+
+static int split_bt_report_input(uint8_t downstream, uint8_t reg, uint8_t type, uint16_t code,
+                                 int32_t value, bool sync) {
+    const struct bt_gatt_attr *attr = input_attr_for_reg(reg);
+    if (!attr) {
+        return -ENODEV;
+    }
+
+    struct zmk_split_input_event_payload payload = {
+        .downstream = downstream,
+        .type = type,
+        .code = code,
+        .value = value,
+        .sync = sync ? 1 : 0,
+    };
+
+    return bt_gatt_notify(NULL, attr, &payload, sizeof(payload));
+}
+
+static int split_bt_report_input_frame(uint8_t downstream, uint8_t reg, uint8_t axes,
+                                       const int16_t *values) {
+    const struct bt_gatt_attr *attr = input_attr_for_reg(reg);
+    if (!attr) {
+        return -ENODEV;
+    }
+
+    struct zmk_split_input_frame_payload payload = {.downstream = downstream, .axes = axes};
+    for (size_t i = 0; i < ARRAY_SIZE(payload.values); i++) {
+        payload.values[i] = sys_cpu_to_le16(values[i]);
+    }
+
+    return bt_gatt_notify(NULL, attr, &payload, sizeof(payload));
 }
 
 #endif /* IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT) */
 
+static int split_bt_report_event(const struct zmk_split_transport_peripheral_event *ev) {
+    switch (ev->type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+        return queue_key_event(&(struct key_event_item){
+            .position = ev->data.key_position_event.position,
+            .pressed = ev->data.key_position_event.pressed,
+            .downstream = ev->downstream,
+            .timestamp = ev->data.key_position_event.timestamp,
+        });
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT:
+        return queue_key_event(&(struct key_event_item){
+            .position = ev->data.keycode_event.position,
+            .pressed = ev->data.keycode_event.pressed,
+            .downstream = ev->downstream,
+            .timestamp = ev->data.keycode_event.timestamp,
+            .resolved = true,
+            .keycode = ev->data.keycode_event.keycode,
+            .layers = ev->data.keycode_event.layers,
+        });
+#if ZMK_KEYMAP_HAS_SENSORS
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
+        return split_bt_sensor_triggered(ev->downstream, ev->data.sensor_event.sensor_index,
+                                         ev->data.sensor_event.channel_data,
+                                         ev->data.sensor_event.channel_data_size);
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT:
+        return split_bt_report_input(ev->downstream, ev->data.input_event.reg,
+                                     ev->data.input_event.type, ev->data.input_event.code,
+                                     ev->data.input_event.value, ev->data.input_event.sync);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_FRAME: {
+        int16_t values[ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_COUNT];
+        memcpy(values, ev->data.input_frame.values, sizeof(values));
+
+        return split_bt_report_input_frame(ev->downstream, ev->data.input_frame.reg,
+                                           ev->data.input_frame.axes, values);
+    }
+#endif /* IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT) */
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static const struct zmk_split_transport_peripheral_api bt_peripheral_api = {
+    .report_event = split_bt_report_event,
+};
+
+ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(bt_peripheral_transport, &bt_peripheral_api);
+
 static int service_init(void) {
     static const struct k_work_queue_config queue_config = {
         .name = "Split Peripheral Notification Queue"};
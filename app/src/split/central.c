@@ -0,0 +1,666 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/stdlib.h>
+#include <zmk/behavior.h>
+#include <zmk/sensors.h>
+#include <zmk/split/central.h>
+#include <zmk/split/transport/central.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+#include <zmk/physical_layouts.h>
+#include <zmk/pointing/input_split.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+#include <zephyr/sys/atomic.h>
+
+#include <zmk/endpoints.h>
+#include <zmk/keymap.h>
+#include <zmk/events/endpoint_changed.h>
+#include <zmk/events/layer_state_changed.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC) && IS_ENABLED(CONFIG_ZMK_WPM)
+#include <zmk/wpm.h>
+#include <zmk/events/wpm_state_changed.h>
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+#include <zmk/matrix.h>
+#include <zmk/events/keycode_state_changed.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+static const struct zmk_split_transport_central *active_transport;
+
+struct peripheral_event_item {
+    uint8_t source;
+    int64_t timestamp;
+    struct zmk_split_transport_peripheral_event event;
+};
+
+/*
+ * Tracks the offset between a peripheral's clock and ours, so key events can be stamped with the
+ * time they happened on the peripheral instead of the time they arrived. The offset is the
+ * smallest (arrival - peripheral time) seen over the last one to two windows, so rebased times
+ * trail real time by about the lowest recent latency on the link, and events keep their relative
+ * timing within a batch. Taking the minimum over a window instead of all time lets the offset
+ * rise again when the clocks drift apart or the link gets slower.
+ */
+struct peripheral_clock {
+    bool synced;
+    // Our uptime when the peripheral's clock read 0, modulo 2^32.
+    uint32_t offset;
+    // The smallest offset seen since the current window started.
+    uint32_t window_offset;
+    int64_t window_start;
+    int64_t last_timestamp;
+};
+
+static struct peripheral_clock peripheral_clocks[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+
+// Offsets wrap around, so they're compared by their difference.
+static bool offset_before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+static int64_t rebase_peripheral_timestamp(uint8_t source, uint32_t peripheral_time,
+                                           int64_t now) {
+    if (source >= ARRAY_SIZE(peripheral_clocks)) {
+        return now;
+    }
+
+    struct peripheral_clock *clock = &peripheral_clocks[source];
+
+    // Wrapping arithmetic keeps this correct when either clock passes 2^32 ms.
+    const uint32_t offset = (uint32_t)now - peripheral_time;
+
+    if (!clock->synced ||
+        (int32_t)(offset - clock->offset) > CONFIG_ZMK_SPLIT_CENTRAL_PERIPHERAL_CLOCK_RESYNC_MS) {
+        LOG_DBG("Synchronizing to the clock of peripheral %d", source);
+        clock->synced = true;
+        clock->offset = offset;
+        clock->window_offset = offset;
+        clock->window_start = now;
+    } else {
+        if (offset_before(offset, clock->offset)) {
+            // Faster than any recent event, so our offset was too large.
+            clock->offset = offset;
+        }
+
+        if (offset_before(offset, clock->window_offset)) {
+            clock->window_offset = offset;
+        }
+
+        if (now - clock->window_start >= CONFIG_ZMK_SPLIT_CENTRAL_PERIPHERAL_CLOCK_WINDOW_MS) {
+            // Forget offsets from before the window that just ended, which may be too small now.
+            clock->offset = clock->window_offset;
+            clock->window_offset = offset;
+            clock->window_start = now;
+        }
+    }
+
+    const int32_t age = (int32_t)(offset - clock->offset);
+
+    // An offset correction must not reorder events that were already raised.
+    clock->last_timestamp = MAX(now - age, clock->last_timestamp);
+
+    return clock->last_timestamp;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+
+static struct zmk_split_central_peripheral_stats
+    peripheral_stats[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+static uint64_t press_latency_total_ms[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+static uint32_t event_queue_high_water;
+
+#define STATS_FOR(source)                                                                          \
+    ((source) < ARRAY_SIZE(peripheral_stats) ? &peripheral_stats[source] : NULL)
+
+static void record_press_latency(uint8_t source, int64_t latency) {
+    struct zmk_split_central_peripheral_stats *stats = STATS_FOR(source);
+    if (!stats) {
+        return;
+    }
+
+    stats->presses++;
+    press_latency_total_ms[source] += latency;
+    stats->press_latency_max_ms = MAX(stats->press_latency_max_ms, (uint32_t)latency);
+}
+
+int zmk_split_central_get_peripheral_stats(uint8_t source,
+                                           struct zmk_split_central_peripheral_stats *stats) {
+    if (source >= ARRAY_SIZE(peripheral_stats)) {
+        return -EINVAL;
+    }
+
+    *stats = peripheral_stats[source];
+    if (stats->presses > 0) {
+        stats->press_latency_avg_ms = press_latency_total_ms[source] / stats->presses;
+    }
+
+    return 0;
+}
+
+int zmk_split_central_get_event_queue_high_water(void) { return event_queue_high_water; }
+
+int zmk_split_central_reset_stats(void) {
+    // Connections are a lifetime count, everything else starts over.
+    for (size_t i = 0; i < ARRAY_SIZE(peripheral_stats); i++) {
+        peripheral_stats[i] = (struct zmk_split_central_peripheral_stats){
+            .connections = peripheral_stats[i].connections,
+        };
+        press_latency_total_ms[i] = 0;
+    }
+
+    event_queue_high_water = 0;
+
+    return 0;
+}
+
+#define STATS_INC(source, field)                                                                   \
+    do {                                                                                           \
+        struct zmk_split_central_peripheral_stats *_stats = STATS_FOR(source);                     \
+        if (_stats) {                                                                              \
+            _stats->field++;                                                                       \
+        }                                                                                          \
+    } while (0)
+
+#else
+
+int zmk_split_central_get_peripheral_stats(uint8_t source,
+                                           struct zmk_split_central_peripheral_stats *stats) {
+    return -ENOTSUP;
+}
+
+int zmk_split_central_get_event_queue_high_water(void) { return -ENOTSUP; }
+
+int zmk_split_central_reset_stats(void) { return -ENOTSUP; }
+
+#define STATS_INC(source, field)
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+
+void zmk_split_transport_central_peripheral_connected(
+    const struct zmk_split_transport_central *transport, uint8_t source) {
+    STATS_INC(source, connections);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+// Positions pressed by keys peripherals resolved, and the keycodes they pressed.
+static uint8_t resolved_positions[DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)];
+static uint32_t resolved_keycodes[ZMK_KEYMAP_LEN];
+
+// Positions held that went through the keymap, and the time of the last such key event.
+static uint8_t raw_positions_held[DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)];
+static int64_t last_raw_key_event = -CONFIG_ZMK_SPLIT_CENTRAL_LOCAL_KEYMAP_IDLE_MS;
+
+static bool can_apply_resolved_key(uint32_t layers, int64_t timestamp) {
+    if (layers != zmk_keymap_layer_state()) {
+        return false;
+    }
+
+    // Hold-taps, tap-dances and combos waiting on a decision need to see the position.
+    for (size_t i = 0; i < ARRAY_SIZE(raw_positions_held); i++) {
+        if (raw_positions_held[i]) {
+            return false;
+        }
+    }
+
+    return timestamp - last_raw_key_event >= CONFIG_ZMK_SPLIT_CENTRAL_LOCAL_KEYMAP_IDLE_MS;
+}
+
+static bool release_resolved_key(uint16_t position, int64_t timestamp) {
+    if (position >= ZMK_KEYMAP_LEN || !(resolved_positions[position / 8] & BIT(position % 8))) {
+        return false;
+    }
+
+    WRITE_BIT(resolved_positions[position / 8], position % 8, false);
+    raise_zmk_keycode_state_changed_from_encoded(resolved_keycodes[position], false, timestamp);
+    return true;
+}
+
+static bool press_resolved_key(const struct peripheral_event_item *item) {
+    const uint16_t position = item->event.data.keycode_event.position;
+    const uint32_t keycode = item->event.data.keycode_event.keycode;
+
+    if (position >= ZMK_KEYMAP_LEN ||
+        !can_apply_resolved_key(item->event.data.keycode_event.layers, item->timestamp)) {
+        return false;
+    }
+
+    LOG_DBG("Applying keycode 0x%08X resolved by peripheral %d for position %d", keycode,
+            item->source, position);
+
+    WRITE_BIT(resolved_positions[position / 8], position % 8, true);
+    resolved_keycodes[position] = keycode;
+    raise_zmk_keycode_state_changed_from_encoded(keycode, true, item->timestamp);
+    return true;
+}
+
+static void note_raw_key_event(const struct zmk_position_state_changed *ev) {
+    if (ev->position < ZMK_KEYMAP_LEN) {
+        WRITE_BIT(raw_positions_held[ev->position / 8], ev->position % 8, ev->state);
+    }
+
+    last_raw_key_event = ev->timestamp;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+static void handle_resolved_key(const struct peripheral_event_item *item) {
+    const struct zmk_split_transport_peripheral_event *ev = &item->event;
+    const bool pressed = ev->data.keycode_event.pressed != 0;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+    if (pressed ? press_resolved_key(item)
+                : release_resolved_key(ev->data.keycode_event.position, item->timestamp)) {
+        return;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+    // Otherwise the central resolves the position itself.
+    LOG_DBG("Trigger key position state change for %d", ev->data.keycode_event.position);
+    raise_zmk_position_state_changed((struct zmk_position_state_changed){
+        .source = item->source,
+        .position = ev->data.keycode_event.position,
+        .state = pressed,
+        .timestamp = item->timestamp,
+    });
+}
+
+K_MSGQ_DEFINE(peripheral_event_msgq, sizeof(struct peripheral_event_item),
+              CONFIG_ZMK_SPLIT_CENTRAL_EVENT_QUEUE_SIZE, 4);
+
+static void handle_peripheral_event(const struct peripheral_event_item *item) {
+    const struct zmk_split_transport_peripheral_event *ev = &item->event;
+
+    switch (ev->type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+        // Releases generated on disconnect arrive as positions, even for resolved keys.
+        if (!ev->data.key_position_event.pressed &&
+            release_resolved_key(ev->data.key_position_event.position, item->timestamp)) {
+            break;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+        LOG_DBG("Trigger key position state change for %d", ev->data.key_position_event.position);
+        raise_zmk_position_state_changed((struct zmk_position_state_changed){
+            .source = item->source,
+            .position = ev->data.key_position_event.position,
+            .state = ev->data.key_position_event.pressed != 0,
+            .timestamp = item->timestamp,
+        });
+        break;
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT:
+        handle_resolved_key(item);
+        break;
+#if ZMK_KEYMAP_HAS_SENSORS
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT: {
+        struct zmk_sensor_event sensor_ev = {
+            .sensor_index = ev->data.sensor_event.sensor_index,
+            .channel_data_size =
+                MIN(ev->data.sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
+            .timestamp = item->timestamp,
+        };
+
+        memcpy(sensor_ev.channel_data, ev->data.sensor_event.channel_data,
+               sizeof(struct zmk_sensor_channel_data) * sensor_ev.channel_data_size);
+
+        LOG_DBG("Trigger sensor change for %d", sensor_ev.sensor_index);
+        raise_zmk_sensor_event(sensor_ev);
+        break;
+    }
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT: {
+        int ret = zmk_input_split_report_peripheral_event(
+            ev->data.input_event.reg, ev->data.input_event.type, ev->data.input_event.code,
+            ev->data.input_event.value, ev->data.input_event.sync);
+        if (ret < 0) {
+            LOG_WRN("Failed to report peripheral event %d", ret);
+        }
+        break;
+    }
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_FRAME: {
+        int16_t values[ZMK_SPLIT_TRANSPORT_INPUT_FRAME_AXIS_COUNT];
+        memcpy(values, ev->data.input_frame.values, sizeof(values));
+
+        int ret = zmk_input_split_report_peripheral_frame(ev->data.input_frame.reg,
+                                                          ev->data.input_frame.axes, values);
+        if (ret < 0) {
+            LOG_WRN("Failed to report peripheral input frame %d", ret);
+        }
+        break;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    default:
+        LOG_WRN("Unsupported peripheral event type %d", ev->type);
+        break;
+    }
+}
+
+static void peripheral_event_work_callback(struct k_work *work) {
+    struct peripheral_event_item item;
+    while (k_msgq_get(&peripheral_event_msgq, &item, K_NO_WAIT) == 0) {
+        handle_peripheral_event(&item);
+    }
+}
+
+static K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
+
+int zmk_split_transport_central_peripheral_event_handler(
+    const struct zmk_split_transport_central *transport, uint8_t source,
+    struct zmk_split_transport_peripheral_event ev) {
+    const int64_t now = k_uptime_get();
+    struct peripheral_event_item item = {
+        .source = source,
+        .timestamp = now,
+        .event = ev,
+    };
+
+    STATS_INC(source, events_received);
+
+    if (ev.type == ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT) {
+        item.timestamp =
+            rebase_peripheral_timestamp(source, ev.data.key_position_event.timestamp, now);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+        if (ev.data.key_position_event.pressed) {
+            record_press_latency(source, now - item.timestamp);
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+    } else if (ev.type == ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT) {
+        item.timestamp = rebase_peripheral_timestamp(source, ev.data.keycode_event.timestamp, now);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+        if (ev.data.keycode_event.pressed) {
+            record_press_latency(source, now - item.timestamp);
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+    }
+
+    int err = k_msgq_put(&peripheral_event_msgq, &item, K_NO_WAIT);
+    if (err < 0) {
+        LOG_WRN("Dropping peripheral event from %d, queue full", source);
+        STATS_INC(source, events_dropped);
+        return -ENOMEM;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+    event_queue_high_water =
+        MAX(event_queue_high_water, k_msgq_num_used_get(&peripheral_event_msgq));
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CENTRAL_STATS)
+
+    k_work_submit(&peripheral_event_work);
+
+    return 0;
+}
+
+static int send_command(uint8_t source, struct zmk_split_transport_central_command cmd) {
+    if (!active_transport) {
+        return -ENODEV;
+    }
+
+    int ret = active_transport->api->send_command(source, cmd);
+
+    STATS_INC(source, commands_sent);
+    if (ret < 0) {
+        STATS_INC(source, commands_failed);
+    }
+
+    return ret;
+}
+
+static int send_command_to_all(struct zmk_split_transport_central_command cmd) {
+    uint8_t sources[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+    int ret = 0;
+
+    const int count = zmk_split_central_get_available_source_ids(sources);
+    for (int i = 0; i < count; i++) {
+        int err = send_command(sources[i], cmd);
+        if (err < 0) {
+            ret = err;
+        }
+    }
+
+    return ret;
+}
+
+int zmk_split_central_get_available_source_ids(uint8_t *sources) {
+    if (!active_transport) {
+        return 0;
+    }
+
+    return active_transport->api->get_available_source_ids(sources);
+}
+
+int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event, bool state) {
+    struct zmk_split_transport_central_command cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
+        .data.invoke_behavior =
+            {
+                .param1 = binding->param1,
+                .param2 = binding->param2,
+                .position = event.position,
+                .event_source = event.source,
+                .state = state ? 1 : 0,
+            },
+    };
+
+    const size_t dev_size = sizeof(cmd.data.invoke_behavior.behavior_dev);
+    if (strlcpy(cmd.data.invoke_behavior.behavior_dev, binding->behavior_dev, dev_size) >=
+        dev_size) {
+        LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
+                binding->behavior_dev, cmd.data.invoke_behavior.behavior_dev);
+    }
+
+    return send_command(source, cmd);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+#define STATE_SYNC_ALL_FIELDS                                                                      \
+    (ZMK_SPLIT_TRANSPORT_STATE_SYNC_LAYERS |                                                       \
+     (IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)                                       \
+          ? ZMK_SPLIT_TRANSPORT_STATE_SYNC_HID_INDICATORS                                          \
+          : 0) |                                                                                   \
+     (IS_ENABLED(CONFIG_ZMK_WPM) ? ZMK_SPLIT_TRANSPORT_STATE_SYNC_WPM : 0) |                       \
+     ZMK_SPLIT_TRANSPORT_STATE_SYNC_ENDPOINT)
+
+// Peripherals that have (re)connected and need every field, rather than only the changed ones.
+static ATOMIC_DEFINE(state_sync_full_sources, ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT);
+
+static struct zmk_split_transport_state_sync last_synced_state;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+static zmk_hid_indicators_t hid_indicators;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+static void get_current_state(struct zmk_split_transport_state_sync *state) {
+    *state = (struct zmk_split_transport_state_sync){
+        .version = ZMK_SPLIT_TRANSPORT_STATE_SYNC_VERSION,
+        .fields = STATE_SYNC_ALL_FIELDS,
+        .layers = zmk_keymap_layer_state(),
+    };
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    state->hid_indicators = hid_indicators;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#if IS_ENABLED(CONFIG_ZMK_WPM)
+    state->wpm = zmk_wpm_get_state();
+#endif // IS_ENABLED(CONFIG_ZMK_WPM)
+
+    const struct zmk_endpoint_instance endpoint = zmk_endpoints_selected();
+    state->endpoint_transport = endpoint.transport;
+    if (endpoint.transport == ZMK_TRANSPORT_BLE) {
+        state->endpoint_ble_profile = endpoint.ble.profile_index;
+    }
+}
+
+static uint8_t changed_state_fields(const struct zmk_split_transport_state_sync *old,
+                                    const struct zmk_split_transport_state_sync *state) {
+    uint8_t changed = 0;
+
+    if (old->layers != state->layers) {
+        changed |= ZMK_SPLIT_TRANSPORT_STATE_SYNC_LAYERS;
+    }
+    if (old->hid_indicators != state->hid_indicators) {
+        changed |= ZMK_SPLIT_TRANSPORT_STATE_SYNC_HID_INDICATORS;
+    }
+    if (old->wpm != state->wpm) {
+        changed |= ZMK_SPLIT_TRANSPORT_STATE_SYNC_WPM;
+    }
+    if (old->endpoint_transport != state->endpoint_transport ||
+        old->endpoint_ble_profile != state->endpoint_ble_profile) {
+        changed |= ZMK_SPLIT_TRANSPORT_STATE_SYNC_ENDPOINT;
+    }
+
+    return changed & STATE_SYNC_ALL_FIELDS;
+}
+
+static void state_sync_work_callback(struct k_work *work) {
+    struct zmk_split_transport_state_sync state;
+    get_current_state(&state);
+
+    const uint8_t changed = changed_state_fields(&last_synced_state, &state);
+    last_synced_state = state;
+
+    uint8_t sources[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+    const int count = zmk_split_central_get_available_source_ids(sources);
+    for (int i = 0; i < count; i++) {
+        const bool full = atomic_test_bit(state_sync_full_sources, sources[i]);
+        struct zmk_split_transport_central_command cmd = {
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_STATE_SYNC,
+            .data.state_sync = state,
+        };
+
+        cmd.data.state_sync.fields = full ? STATE_SYNC_ALL_FIELDS : changed;
+        if (cmd.data.state_sync.fields == 0) {
+            continue;
+        }
+
+        int err = send_command(sources[i], cmd);
+        if (err < 0) {
+            // Unsent changes are lost from last_synced_state, so resend everything next time.
+            LOG_DBG("Failed to sync state to peripheral %d (%d)", sources[i], err);
+            atomic_set_bit(state_sync_full_sources, sources[i]);
+        } else if (full) {
+            atomic_clear_bit(state_sync_full_sources, sources[i]);
+        }
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(state_sync_work, state_sync_work_callback);
+
+static void schedule_state_sync(void) {
+    // Not rescheduled, so a burst of changes within the delay is sent as one command.
+    k_work_schedule(&state_sync_work, K_MSEC(CONFIG_ZMK_SPLIT_CENTRAL_STATE_SYNC_DELAY_MS));
+}
+
+void zmk_split_transport_central_request_state_sync(
+    const struct zmk_split_transport_central *transport, uint8_t source) {
+    if (source >= ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT) {
+        return;
+    }
+
+    atomic_set_bit(state_sync_full_sources, source);
+    schedule_state_sync();
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+int zmk_split_central_update_hid_indicator(zmk_hid_indicators_t indicators) {
+    hid_indicators = indicators;
+    schedule_state_sync();
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#else
+
+void zmk_split_transport_central_request_state_sync(
+    const struct zmk_split_transport_central *transport, uint8_t source) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+static int split_central_listener_cb(const zmk_event_t *eh) {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+    const struct zmk_position_state_changed *pos_ev = as_zmk_position_state_changed(eh);
+    if (pos_ev) {
+        note_raw_key_event(pos_ev);
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+    const struct zmk_physical_layout_selection_changed *ev =
+        as_zmk_physical_layout_selection_changed(eh);
+    if (ev) {
+        send_command_to_all((struct zmk_split_transport_central_command){
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT,
+            .data.set_physical_layout = {.layout_idx = ev->selection},
+        });
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    schedule_state_sync();
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(split_central, split_central_listener_cb);
+ZMK_SUBSCRIPTION(split_central, zmk_physical_layout_selection_changed);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+ZMK_SUBSCRIPTION(split_central, zmk_layer_state_changed);
+ZMK_SUBSCRIPTION(split_central, zmk_endpoint_changed);
+#if IS_ENABLED(CONFIG_ZMK_WPM)
+ZMK_SUBSCRIPTION(split_central, zmk_wpm_state_changed);
+#endif // IS_ENABLED(CONFIG_ZMK_WPM)
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+ZMK_SUBSCRIPTION(split_central, zmk_position_state_changed);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+static int zmk_split_central_init(void) {
+    STRUCT_SECTION_FOREACH(zmk_split_transport_central, transport) {
+        active_transport = transport;
+        break;
+    }
+
+    if (!active_transport) {
+        LOG_ERR("No split central transport registered");
+        return -ENODEV;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    for (uint8_t source = 0; source < ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT; source++) {
+        atomic_set_bit(state_sync_full_sources, source);
+    }
+
+    schedule_state_sync();
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_central_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/shell/shell.h>
+
+#include <zmk/split/central.h>
+
+static int cmd_split_stats(const struct shell *sh, size_t argc, char **argv) {
+    for (uint8_t source = 0; source < ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT; source++) {
+        struct zmk_split_central_peripheral_stats stats;
+        int err = zmk_split_central_get_peripheral_stats(source, &stats);
+        if (err < 0) {
+            shell_error(sh, "Failed to get stats for peripheral %d (%d)", source, err);
+            return err;
+        }
+
+        shell_print(sh, "Peripheral %d:", source);
+        shell_print(sh, "  connections:     %u", stats.connections);
+        shell_print(sh, "  events received: %u", stats.events_received);
+        shell_print(sh, "  events dropped:  %u", stats.events_dropped);
+        shell_print(sh, "  commands sent:   %u", stats.commands_sent);
+        shell_print(sh, "  commands failed: %u", stats.commands_failed);
+        shell_print(sh, "  press latency:   avg %u ms, max %u ms over %u presses",
+                    stats.press_latency_avg_ms, stats.press_latency_max_ms, stats.presses);
+    }
+
+    shell_print(sh, "Event queue high water: %d/%d", zmk_split_central_get_event_queue_high_water(),
+                CONFIG_ZMK_SPLIT_CENTRAL_EVENT_QUEUE_SIZE);
+
+    return 0;
+}
+
+static int cmd_split_stats_reset(const struct shell *sh, size_t argc, char **argv) {
+    int err = zmk_split_central_reset_stats();
+    if (err < 0) {
+        shell_error(sh, "Failed to reset stats (%d)", err);
+        return err;
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_split_stats,
+                               SHELL_CMD(reset, NULL, "Reset split link statistics",
+                                         cmd_split_stats_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_split,
+                               SHELL_CMD(stats, &sub_split_stats, "Show split link statistics",
+                                         cmd_split_stats),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(split, &sub_split, "Split keyboard commands", NULL);
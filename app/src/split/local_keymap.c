@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/matrix.h>
+#include <zmk/split/peripheral.h>
+
+/*
+ * Resolves the peripheral's key positions against its own copy of the keymap, using the layer
+ * state synced from the central. Only plain key press bindings are resolved. Anything else, and
+ * any position that is part of a combo, is left for the central to handle from the raw position.
+ */
+
+#define KEYMAP_NODE DT_INST(0, zmk_keymap)
+
+enum local_binding_type {
+    LOCAL_BINDING_RAW,
+    LOCAL_BINDING_TRANSPARENT,
+    LOCAL_BINDING_KEY_PRESS,
+};
+
+struct local_binding {
+    uint8_t type;
+    uint32_t keycode;
+};
+
+#define BINDING_HAS_COMPAT(layer, idx, compat)                                                     \
+    DT_NODE_HAS_COMPAT(DT_PHANDLE_BY_IDX(layer, bindings, idx), compat)
+
+#define LOCAL_BINDING(idx, layer)                                                                  \
+    {                                                                                              \
+        .type = BINDING_HAS_COMPAT(layer, idx, zmk_behavior_key_press)                             \
+                    ? LOCAL_BINDING_KEY_PRESS                                                      \
+                    : (BINDING_HAS_COMPAT(layer, idx, zmk_behavior_transparent)                    \
+                           ? LOCAL_BINDING_TRANSPARENT                                             \
+                           : LOCAL_BINDING_RAW),                                                   \
+        .keycode = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(layer, bindings, idx, param1), (0),          \
+                               (DT_PHA_BY_IDX(layer, bindings, idx, param1))),                     \
+    }
+
+#define LOCAL_LAYER(layer)                                                                         \
+    {COND_CODE_1(DT_NODE_HAS_PROP(layer, bindings),                                                \
+                 (LISTIFY(DT_PROP_LEN(layer, bindings), LOCAL_BINDING, (, ), layer)), ())}
+
+#define LAYER_PLUS_ONE(layer) 1 +
+#define LOCAL_LAYERS_LEN (DT_FOREACH_CHILD_STATUS_OKAY(KEYMAP_NODE, LAYER_PLUS_ONE) 0)
+
+// Positions a layer doesn't bind are zero initialized, which leaves them to the central.
+static const struct local_binding local_keymap[LOCAL_LAYERS_LEN][ZMK_KEYMAP_LEN] = {
+    DT_FOREACH_CHILD_STATUS_OKAY_SEP(KEYMAP_NODE, LOCAL_LAYER, (, ))};
+
+BUILD_ASSERT(LOCAL_LAYERS_LEN <= 32, "The synced layer state only covers 32 layers");
+
+#if DT_HAS_COMPAT_STATUS_OKAY(zmk_combos)
+
+#define COMBO_POSITION(idx, combo) DT_PROP_BY_IDX(combo, key_positions, idx),
+#define COMBO_POSITIONS(combo) LISTIFY(DT_PROP_LEN(combo, key_positions), COMBO_POSITION, (), combo)
+
+static const uint16_t combo_positions[] = {
+    DT_FOREACH_CHILD(DT_INST(0, zmk_combos), COMBO_POSITIONS)};
+
+#endif // DT_HAS_COMPAT_STATUS_OKAY(zmk_combos)
+
+// Positions the central must always see, because a combo may need them.
+static uint8_t raw_positions[DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)];
+
+// The keycode each resolved press sent, so its release matches even if the layers changed since.
+static uint8_t resolved_positions[DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)];
+static uint32_t resolved_keycodes[ZMK_KEYMAP_LEN];
+
+static bool position_bit(const uint8_t *bits, uint32_t position) {
+    return (bits[position / 8] & BIT(position % 8)) != 0;
+}
+
+int zmk_split_peripheral_keymap_resolve(uint32_t position, bool pressed, uint32_t *keycode,
+                                        uint32_t *layers) {
+    if (position >= ZMK_KEYMAP_LEN) {
+        return -EINVAL;
+    }
+
+    *layers = zmk_split_peripheral_get_layer_state();
+
+    if (!pressed) {
+        if (!position_bit(resolved_positions, position)) {
+            return -ENOENT;
+        }
+
+        WRITE_BIT(resolved_positions[position / 8], position % 8, false);
+        *keycode = resolved_keycodes[position];
+        return 0;
+    }
+
+    if (position_bit(raw_positions, position)) {
+        return -ENOENT;
+    }
+
+    // Walk down from the highest active layer like the central's keymap does. The default layer
+    // is always active.
+    for (int layer = LOCAL_LAYERS_LEN - 1; layer >= 0; layer--) {
+        if (layer != 0 && !(*layers & BIT(layer))) {
+            continue;
+        }
+
+        const struct local_binding *binding = &local_keymap[layer][position];
+        if (binding->type == LOCAL_BINDING_TRANSPARENT) {
+            continue;
+        }
+
+        if (binding->type != LOCAL_BINDING_KEY_PRESS) {
+            return -ENOENT;
+        }
+
+        WRITE_BIT(resolved_positions[position / 8], position % 8, true);
+        resolved_keycodes[position] = binding->keycode;
+        *keycode = binding->keycode;
+        return 0;
+    }
+
+    return -ENOENT;
+}
+
+static int local_keymap_init(void) {
+#if DT_HAS_COMPAT_STATUS_OKAY(zmk_combos)
+    for (size_t i = 0; i < ARRAY_SIZE(combo_positions); i++) {
+        if (combo_positions[i] < ZMK_KEYMAP_LEN) {
+            WRITE_BIT(raw_positions[combo_positions[i] / 8], combo_positions[i] % 8, true);
+        }
+    }
+#endif // DT_HAS_COMPAT_STATUS_OKAY(zmk_combos)
+
+    return 0;
+}
+
+SYS_INIT(local_keymap_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/kscan.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/benchmark.h>
+#include <zmk/matrix_transform.h>
+#include <zmk/physical_layouts.h>
+#include <zmk/split/peripheral.h>
+#include <zmk/split/transport/central.h>
+#include <zmk/split/transport/peripheral.h>
+
+/*
+ * A simulated split link for running the central and a peripheral in one process. Messages in
+ * both directions are delivered on the system work queue after a configurable delay, and may be
+ * dropped or reordered. All randomness comes from a seeded PRNG, so a test run is reproducible.
+ */
+
+// The simulated peripheral is the only one connected to the central.
+#define LOOPBACK_PERIPHERAL_SOURCE 0
+
+#define PERIPHERAL_KSCAN DT_CHOSEN(zmk_split_loopback_kscan)
+
+enum link_direction {
+    LINK_TO_CENTRAL,
+    LINK_TO_PERIPHERAL,
+};
+
+struct link_message {
+    bool in_flight;
+    uint8_t direction;
+    // Ties between messages due at the same time are delivered in the order they were sent.
+    uint32_t seq;
+    int64_t deliver_at;
+    int64_t sent_at;
+    union {
+        struct zmk_split_transport_peripheral_event event;
+        struct zmk_split_transport_central_command command;
+    } data;
+};
+
+extern const struct zmk_split_transport_central loopback_central_transport;
+extern const struct zmk_split_transport_peripheral loopback_peripheral_transport;
+
+static struct link_message messages[CONFIG_ZMK_SPLIT_LOOPBACK_QUEUE_SIZE];
+static uint32_t next_seq;
+static uint32_t rng_state = CONFIG_ZMK_SPLIT_LOOPBACK_SEED ? CONFIG_ZMK_SPLIT_LOOPBACK_SEED : 1;
+static struct k_spinlock lock;
+
+static void deliver_work_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(deliver_work, deliver_work_callback);
+
+// xorshift32, which is plenty for picking delays and is stable across platforms.
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static bool rng_percent(uint32_t percent) { return percent > 0 && rng_next() % 100 < percent; }
+
+static struct link_message *next_due_message(void) {
+    struct link_message *next = NULL;
+
+    for (size_t i = 0; i < ARRAY_SIZE(messages); i++) {
+        struct link_message *msg = &messages[i];
+        if (!msg->in_flight) {
+            continue;
+        }
+
+        if (!next || msg->deliver_at < next->deliver_at ||
+            (msg->deliver_at == next->deliver_at && (int32_t)(msg->seq - next->seq) < 0)) {
+            next = msg;
+        }
+    }
+
+    return next;
+}
+
+static void schedule_delivery(void) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct link_message *next = next_due_message();
+    const int64_t deliver_at = next ? next->deliver_at : 0;
+    k_spin_unlock(&lock, key);
+
+    if (next) {
+        k_work_reschedule(&deliver_work, K_MSEC(MAX(deliver_at - k_uptime_get(), 0)));
+    }
+}
+
+static int link_send(enum link_direction direction, const void *data, size_t len) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (rng_percent(CONFIG_ZMK_SPLIT_LOOPBACK_LOSS_PERCENT)) {
+        k_spin_unlock(&lock, key);
+        LOG_DBG("Dropping message %d to the %s", next_seq++,
+                direction == LINK_TO_CENTRAL ? "central" : "peripheral");
+        return 0;
+    }
+
+    struct link_message *msg = NULL;
+    for (size_t i = 0; i < ARRAY_SIZE(messages); i++) {
+        if (!messages[i].in_flight) {
+            msg = &messages[i];
+            break;
+        }
+    }
+
+    if (!msg) {
+        k_spin_unlock(&lock, key);
+        LOG_WRN("Simulated split link is full, dropping message");
+        return -ENOMEM;
+    }
+
+    uint32_t delay = CONFIG_ZMK_SPLIT_LOOPBACK_LATENCY_MS;
+    if (CONFIG_ZMK_SPLIT_LOOPBACK_JITTER_MS > 0) {
+        delay += rng_next() % (CONFIG_ZMK_SPLIT_LOOPBACK_JITTER_MS + 1);
+    }
+
+    // Holding a message back for longer than any other message can take lets the ones sent after
+    // it overtake it.
+    if (rng_percent(CONFIG_ZMK_SPLIT_LOOPBACK_REORDER_PERCENT)) {
+        delay += CONFIG_ZMK_SPLIT_LOOPBACK_LATENCY_MS + CONFIG_ZMK_SPLIT_LOOPBACK_JITTER_MS + 1;
+    }
+
+    msg->in_flight = true;
+    msg->direction = direction;
+    msg->seq = next_seq++;
+    msg->sent_at = k_uptime_get();
+    msg->deliver_at = msg->sent_at + delay;
+    memcpy(&msg->data, data, len);
+
+    k_spin_unlock(&lock, key);
+
+    schedule_delivery();
+
+    return 0;
+}
+
+static void deliver_work_callback(struct k_work *work) {
+    while (true) {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        struct link_message *next = next_due_message();
+        if (!next || next->deliver_at > k_uptime_get()) {
+            k_spin_unlock(&lock, key);
+            break;
+        }
+
+        struct link_message msg = *next;
+        next->in_flight = false;
+        k_spin_unlock(&lock, key);
+
+        LOG_DBG("Delivering message %d to the %s after %d ms", msg.seq,
+                msg.direction == LINK_TO_CENTRAL ? "central" : "peripheral",
+                (int)(k_uptime_get() - msg.sent_at));
+
+        if (msg.direction == LINK_TO_CENTRAL) {
+            zmk_split_transport_central_peripheral_event_handler(
+                &loopback_central_transport, LOOPBACK_PERIPHERAL_SOURCE, msg.data.event);
+        } else {
+            zmk_split_transport_peripheral_command_handler(&loopback_peripheral_transport,
+                                                           msg.data.command);
+        }
+    }
+
+    schedule_delivery();
+}
+
+static int loopback_send_command(uint8_t source, struct zmk_split_transport_central_command cmd) {
+    if (source != LOOPBACK_PERIPHERAL_SOURCE) {
+        return -EINVAL;
+    }
+
+    return link_send(LINK_TO_PERIPHERAL, &cmd, sizeof(cmd));
+}
+
+static int loopback_get_available_source_ids(uint8_t *sources) {
+    sources[0] = LOOPBACK_PERIPHERAL_SOURCE;
+    return 1;
+}
+
+static const struct zmk_split_transport_central_api loopback_central_api = {
+    .send_command = loopback_send_command,
+    .get_available_source_ids = loopback_get_available_source_ids,
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(loopback_central_transport, &loopback_central_api);
+
+static int loopback_report_event(const struct zmk_split_transport_peripheral_event *event) {
+    return link_send(LINK_TO_CENTRAL, event, sizeof(*event));
+}
+
+static const struct zmk_split_transport_peripheral_api loopback_peripheral_api = {
+    .report_event = loopback_report_event,
+};
+
+ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(loopback_peripheral_transport, &loopback_peripheral_api);
+
+static void peripheral_kscan_callback(const struct device *dev, uint32_t row, uint32_t column,
+                                      bool pressed) {
+    // Benchmarks time a peripheral key from here, so the split path is part of its latency.
+    zmk_benchmark_mark(ZMK_BENCHMARK_STAGE_KSCAN);
+
+    // The simulated peripheral shares the central's matrix transform.
+    struct zmk_physical_layout const *const *layouts;
+    zmk_physical_layouts_get_list(&layouts);
+
+    const int selected = zmk_physical_layouts_get_selected();
+    if (selected < 0) {
+        return;
+    }
+
+    const int32_t position = zmk_matrix_transform_row_column_to_position(
+        layouts[selected]->matrix_transform, row, column);
+    if (position < 0) {
+        LOG_WRN("Not found in transform: row: %d, col: %d", row, column);
+        return;
+    }
+
+    LOG_DBG("Peripheral position %d, pressed: %s", position, pressed ? "true" : "false");
+
+    zmk_split_peripheral_report_position(position, pressed, k_uptime_get_32());
+}
+
+static int zmk_split_loopback_init(void) {
+    const struct device *kscan = DEVICE_DT_GET(PERIPHERAL_KSCAN);
+
+    if (!device_is_ready(kscan)) {
+        LOG_ERR("Peripheral kscan device is not ready");
+        return -ENODEV;
+    }
+
+    kscan_config(kscan, peripheral_kscan_callback);
+    kscan_enable_callback(kscan);
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_loopback_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
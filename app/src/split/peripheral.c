@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+#include <zmk/sensors.h>
+#include <zmk/physical_layouts.h>
+#include <zmk/split/peripheral.h>
+#include <zmk/split/transport/peripheral.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+#include <zmk/events/endpoint_changed.h>
+#include <zmk/events/layer_state_changed.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#include <zmk/events/hid_indicators_changed.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC) && IS_ENABLED(CONFIG_ZMK_WPM)
+#include <zmk/wpm.h>
+#include <zmk/events/wpm_state_changed.h>
+#endif
+
+static const struct zmk_split_transport_peripheral *active_transport;
+
+int zmk_split_peripheral_report_event(const struct zmk_split_transport_peripheral_event *event) {
+    if (!active_transport) {
+        return -ENODEV;
+    }
+
+    return active_transport->api->report_event(event);
+}
+
+static uint8_t selected_phys_layout = 0;
+
+static void select_phys_layout_callback(struct k_work *work) {
+    LOG_DBG("Selecting physical layout %d requested by central", selected_phys_layout);
+    zmk_physical_layouts_select(selected_phys_layout);
+}
+
+static K_WORK_DEFINE(select_phys_layout_work, select_phys_layout_callback);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+// The central's state as last applied, and any fields received since that are still to be applied.
+static struct zmk_split_transport_state_sync synced_state;
+static struct zmk_split_transport_state_sync pending_state;
+static struct k_spinlock state_sync_lock;
+
+static void merge_state_sync(struct zmk_split_transport_state_sync *dst,
+                             const struct zmk_split_transport_state_sync *src) {
+    if (src->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_LAYERS) {
+        dst->layers = src->layers;
+    }
+    if (src->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_HID_INDICATORS) {
+        dst->hid_indicators = src->hid_indicators;
+    }
+    if (src->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_WPM) {
+        dst->wpm = src->wpm;
+    }
+    if (src->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_ENDPOINT) {
+        dst->endpoint_transport = src->endpoint_transport;
+        dst->endpoint_ble_profile = src->endpoint_ble_profile;
+    }
+
+    dst->fields |= src->fields;
+}
+
+static void raise_state_sync_events(const struct zmk_split_transport_state_sync *old,
+                                    const struct zmk_split_transport_state_sync *state) {
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_LAYERS) {
+        const uint32_t changed = old->layers ^ state->layers;
+        for (uint8_t layer = 0; layer < 32; layer++) {
+            if (changed & BIT(layer)) {
+                raise_layer_state_changed(layer, (state->layers & BIT(layer)) != 0);
+            }
+        }
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_HID_INDICATORS) {
+        raise_zmk_hid_indicators_changed(
+            (struct zmk_hid_indicators_changed){.indicators = state->hid_indicators});
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#if IS_ENABLED(CONFIG_ZMK_WPM)
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_WPM) {
+        raise_zmk_wpm_state_changed((struct zmk_wpm_state_changed){.state = state->wpm});
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_WPM)
+
+    if (state->fields & ZMK_SPLIT_TRANSPORT_STATE_SYNC_ENDPOINT) {
+        struct zmk_endpoint_instance endpoint = {.transport = state->endpoint_transport};
+        if (endpoint.transport == ZMK_TRANSPORT_BLE) {
+            endpoint.ble.profile_index = state->endpoint_ble_profile;
+        }
+
+        raise_zmk_endpoint_changed((struct zmk_endpoint_changed){.endpoint = endpoint});
+    }
+}
+
+static void apply_state_sync_callback(struct k_work *work) {
+    k_spinlock_key_t key = k_spin_lock(&state_sync_lock);
+    const struct zmk_split_transport_state_sync state = pending_state;
+    pending_state.fields = 0;
+    k_spin_unlock(&state_sync_lock, key);
+
+    const struct zmk_split_transport_state_sync old = synced_state;
+    merge_state_sync(&synced_state, &state);
+
+    LOG_DBG("Applying state synced from central, fields 0x%02x", state.fields);
+
+    // The central already raised these events in the loopback transport's shared event manager.
+    if (!IS_ENABLED(CONFIG_ZMK_SPLIT_LOOPBACK)) {
+        raise_state_sync_events(&old, &state);
+    }
+}
+
+static K_WORK_DEFINE(apply_state_sync_work, apply_state_sync_callback);
+
+static int queue_state_sync(const struct zmk_split_transport_state_sync *state) {
+    if (state->version != ZMK_SPLIT_TRANSPORT_STATE_SYNC_VERSION) {
+        LOG_WRN("Ignoring state sync version %d, expected %d", state->version,
+                ZMK_SPLIT_TRANSPORT_STATE_SYNC_VERSION);
+        return -ENOTSUP;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&state_sync_lock);
+    merge_state_sync(&pending_state, state);
+    k_spin_unlock(&state_sync_lock, key);
+
+    k_work_submit(&apply_state_sync_work);
+
+    return 0;
+}
+
+uint32_t zmk_split_peripheral_get_layer_state(void) { return synced_state.layers; }
+
+uint8_t zmk_split_peripheral_get_wpm(void) { return synced_state.wpm; }
+
+#if IS_ENABLED(CONFIG_ZMK_WPM) && !IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+// wpm.c isn't built on peripherals that sync their state, so widgets get the central's WPM.
+int zmk_wpm_get_state(void) { return synced_state.wpm; }
+#endif // IS_ENABLED(CONFIG_ZMK_WPM) && !IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+
+struct zmk_endpoint_instance zmk_split_peripheral_get_endpoint(void) {
+    struct zmk_endpoint_instance endpoint = {.transport = synced_state.endpoint_transport};
+    if (endpoint.transport == ZMK_TRANSPORT_BLE) {
+        endpoint.ble.profile_index = synced_state.endpoint_ble_profile;
+    }
+
+    return endpoint;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+zmk_hid_indicators_t zmk_split_peripheral_get_hid_indicators(void) {
+    return synced_state.hid_indicators;
+}
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+
+static int invoke_behavior(const struct zmk_split_transport_central_command *cmd) {
+    struct zmk_behavior_binding binding = {
+        .param1 = cmd->data.invoke_behavior.param1,
+        .param2 = cmd->data.invoke_behavior.param2,
+        .behavior_dev = cmd->data.invoke_behavior.behavior_dev,
+    };
+    LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+            binding.param2, cmd->data.invoke_behavior.state);
+
+    struct zmk_behavior_binding_event event = {.position = cmd->data.invoke_behavior.position,
+                                               .timestamp = k_uptime_get()};
+    int err;
+    if (cmd->data.invoke_behavior.state > 0) {
+        err = behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        err = behavior_keymap_binding_released(&binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+    }
+
+    return err;
+}
+
+int zmk_split_transport_peripheral_command_handler(
+    const struct zmk_split_transport_peripheral *transport,
+    struct zmk_split_transport_central_command cmd) {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_RELAY)
+    if (cmd.downstream != 0) {
+        return zmk_split_relay_forward_command(cmd);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_RELAY)
+
+    switch (cmd.type) {
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR:
+        // Guard against a label that fills the whole buffer.
+        cmd.data.invoke_behavior.behavior_dev[ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN - 1] = '\0';
+        return invoke_behavior(&cmd);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
+        selected_phys_layout = cmd.data.set_physical_layout.layout_idx;
+        k_work_submit(&select_phys_layout_work);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_RELAY)
+        zmk_split_relay_forward_command(cmd);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_RELAY)
+        return 0;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_STATE_SYNC: {
+        int err = queue_state_sync(&cmd.data.state_sync);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_RELAY)
+        zmk_split_relay_forward_command(cmd);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_RELAY)
+        return err;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATE_SYNC)
+    default:
+        LOG_WRN("Unsupported central command type %d", cmd.type);
+        return -ENOTSUP;
+    }
+}
+
+int zmk_split_peripheral_report_position(uint32_t position, bool pressed, uint32_t timestamp) {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+    uint32_t keycode, layers;
+    if (zmk_split_peripheral_keymap_resolve(position, pressed, &keycode, &layers) == 0) {
+        struct zmk_split_transport_peripheral_event ev = {
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT,
+            .data.keycode_event =
+                {
+                    .position = position,
+                    .pressed = pressed ? 1 : 0,
+                    .timestamp = timestamp,
+                    .keycode = keycode,
+                    .layers = layers,
+                },
+        };
+        return zmk_split_peripheral_report_event(&ev);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_LOCAL_KEYMAP)
+
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+        .data.key_position_event =
+            {
+                .position = position,
+                .pressed = pressed ? 1 : 0,
+                .timestamp = timestamp,
+            },
+    };
+    return zmk_split_peripheral_report_event(&ev);
+}
+
+// With the loopback transport the simulated peripheral shares the central's event manager, and
+// its key events come straight from its own kscan instead.
+#if !IS_ENABLED(CONFIG_ZMK_SPLIT_LOOPBACK)
+
+static int split_peripheral_listener(const zmk_event_t *eh) {
+    const struct zmk_position_state_changed *pos_ev;
+    if ((pos_ev = as_zmk_position_state_changed(eh)) != NULL) {
+        return zmk_split_peripheral_report_position(pos_ev->position, pos_ev->state,
+                                                    (uint32_t)pos_ev->timestamp);
+    }
+
+#if ZMK_KEYMAP_HAS_SENSORS
+    const struct zmk_sensor_event *sensor_ev;
+    if ((sensor_ev = as_zmk_sensor_event(eh)) != NULL) {
+        if (sensor_ev->channel_data_size > ZMK_SENSOR_EVENT_MAX_CHANNELS) {
+            return -EINVAL;
+        }
+
+        struct zmk_split_transport_peripheral_event ev = {
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT,
+            .data.sensor_event =
+                {
+                    .sensor_index = sensor_ev->sensor_index,
+                    .channel_data_size = sensor_ev->channel_data_size,
+                },
+        };
+        memcpy(ev.data.sensor_event.channel_data, sensor_ev->channel_data,
+               sizeof(struct zmk_sensor_channel_data) * sensor_ev->channel_data_size);
+        return zmk_split_peripheral_report_event(&ev);
+    }
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(split_peripheral, split_peripheral_listener);
+ZMK_SUBSCRIPTION(split_peripheral, zmk_position_state_changed);
+
+#if ZMK_KEYMAP_HAS_SENSORS
+ZMK_SUBSCRIPTION(split_peripheral, zmk_sensor_event);
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+#endif // !IS_ENABLED(CONFIG_ZMK_SPLIT_LOOPBACK)
+
+static int zmk_split_peripheral_init(void) {
+    STRUCT_SECTION_FOREACH(zmk_split_transport_peripheral, transport) {
+        active_transport = transport;
+        break;
+    }
+
+    if (!active_transport) {
+        LOG_ERR("No split peripheral transport registered");
+        return -ENODEV;
+    }
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_peripheral_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
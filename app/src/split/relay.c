@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/split/peripheral.h>
+#include <zmk/split/transport/central.h>
+
+/*
+ * A relay is a peripheral that is also the central of a transport, usually wired, that another
+ * peripheral is connected to. The downstream peripheral's events are tagged and passed upstream
+ * over this peripheral's own transport, and commands tagged for it are passed back down.
+ *
+ * Only a single hop is supported: events that already carry a downstream index are dropped.
+ */
+
+// The wired transport connects a single downstream peripheral.
+#define MAX_DOWNSTREAM_PERIPHERALS 1
+
+static const struct zmk_split_transport_central *downstream_transport(void) {
+    STRUCT_SECTION_FOREACH(zmk_split_transport_central, transport) {
+        return transport;
+    }
+
+    return NULL;
+}
+
+int zmk_split_transport_central_peripheral_event_handler(
+    const struct zmk_split_transport_central *transport, uint8_t source,
+    struct zmk_split_transport_peripheral_event ev) {
+    if (ev.downstream != 0) {
+        LOG_WRN("Dropping event that was already relayed by peripheral %d", source);
+        return -ENOTSUP;
+    }
+
+    if (source >= MAX_DOWNSTREAM_PERIPHERALS) {
+        LOG_WRN("Dropping event from unexpected downstream peripheral %d", source);
+        return -EINVAL;
+    }
+
+    ev.downstream = source + 1;
+
+    return zmk_split_peripheral_report_event(&ev);
+}
+
+void zmk_split_transport_central_peripheral_connected(
+    const struct zmk_split_transport_central *transport, uint8_t source) {
+    LOG_DBG("Downstream peripheral %d connected", source);
+}
+
+int zmk_split_relay_forward_command(struct zmk_split_transport_central_command cmd) {
+    const struct zmk_split_transport_central *transport = downstream_transport();
+    if (!transport) {
+        return -ENODEV;
+    }
+
+    if (cmd.downstream != 0) {
+        const uint8_t source = cmd.downstream - 1;
+
+        cmd.downstream = 0;
+        return transport->api->send_command(source, cmd);
+    }
+
+    uint8_t sources[MAX_DOWNSTREAM_PERIPHERALS];
+    int count = transport->api->get_available_source_ids(sources);
+    for (int i = 0; i < count; i++) {
+        int err = transport->api->send_command(sources[i], cmd);
+        if (err) {
+            LOG_WRN("Failed to forward command to downstream peripheral %d (%d)", sources[i], err);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/matrix.h>
+#include <zmk/split/transport/central.h>
+
+#include "wired.h"
+
+// A wired central has a single peripheral on the other end of the UART.
+#define WIRED_PERIPHERAL_SOURCE 0
+
+#define POSITION_STATE_DATA_LEN DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)
+
+extern const struct zmk_split_transport_central wired_central_transport;
+
+/*
+ * The peripheral is considered connected while it sends anything, including the heartbeats it
+ * sends when idle, at least once every CONFIG_ZMK_SPLIT_WIRED_LINK_TIMEOUT_MS. Positions it still
+ * holds when the link goes down are released, like when a BLE peripheral disconnects.
+ */
+static bool link_up;
+static uint8_t position_state[POSITION_STATE_DATA_LEN];
+static uint32_t last_key_event_time;
+static int64_t last_key_event_uptime;
+
+static void link_timeout_callback(struct k_work *work) {
+    LOG_WRN("Wired peripheral disconnected, nothing received for %d ms",
+            CONFIG_ZMK_SPLIT_WIRED_LINK_TIMEOUT_MS);
+    link_up = false;
+
+    const uint32_t release_time =
+        last_key_event_time + (uint32_t)(k_uptime_get() - last_key_event_uptime);
+
+    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
+        for (int j = 0; j < 8; j++) {
+            if (!(position_state[i] & BIT(j))) {
+                continue;
+            }
+
+            struct zmk_split_transport_peripheral_event ev = {
+                .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+                .data.key_position_event =
+                    {
+                        .position = (i * 8) + j,
+                        .pressed = 0,
+                        .timestamp = release_time,
+                    },
+            };
+            zmk_split_transport_central_peripheral_event_handler(&wired_central_transport,
+                                                                 WIRED_PERIPHERAL_SOURCE, ev);
+        }
+    }
+
+    memset(position_state, 0, sizeof(position_state));
+}
+
+static K_WORK_DELAYABLE_DEFINE(link_timeout_work, link_timeout_callback);
+
+static void link_received(void) {
+    k_work_reschedule(&link_timeout_work, K_MSEC(CONFIG_ZMK_SPLIT_WIRED_LINK_TIMEOUT_MS));
+
+    if (link_up) {
+        return;
+    }
+
+    LOG_INF("Wired peripheral connected");
+    link_up = true;
+    zmk_split_transport_central_peripheral_connected(&wired_central_transport,
+                                                     WIRED_PERIPHERAL_SOURCE);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+    // Commands aren't sent while the link is down, so the peripheral may have missed state changes.
+    zmk_split_transport_central_request_state_sync(&wired_central_transport,
+                                                   WIRED_PERIPHERAL_SOURCE);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+}
+
+static void track_key_event(uint32_t position, bool pressed, uint32_t timestamp) {
+    if (position < ZMK_KEYMAP_LEN) {
+        WRITE_BIT(position_state[position / 8], position % 8, pressed);
+    }
+
+    last_key_event_time = timestamp;
+    last_key_event_uptime = k_uptime_get();
+}
+
+static int wired_send_command(uint8_t source, struct zmk_split_transport_central_command cmd) {
+    if (source != WIRED_PERIPHERAL_SOURCE) {
+        return -EINVAL;
+    }
+
+    if (!link_up) {
+        return -ENOTCONN;
+    }
+
+    const size_t len = zmk_split_wired_central_command_size(&cmd);
+    if (len == 0) {
+        return -ENOTSUP;
+    }
+
+    return zmk_split_wired_send(&cmd, len);
+}
+
+static int wired_get_available_source_ids(uint8_t *sources) {
+    if (!link_up) {
+        return 0;
+    }
+
+    sources[0] = WIRED_PERIPHERAL_SOURCE;
+    return 1;
+}
+
+void zmk_split_wired_handle_message(const uint8_t *payload, size_t len) {
+    struct zmk_split_transport_peripheral_event ev = {0};
+
+    link_received();
+
+    if (len == 0) {
+        // A heartbeat, which only keeps the link up.
+        return;
+    }
+
+    if (len > sizeof(ev)) {
+        LOG_WRN("Discarding oversized peripheral event (%zu bytes)", len);
+        return;
+    }
+
+    memcpy(&ev, payload, len);
+
+    if (zmk_split_wired_peripheral_event_size(&ev) != len) {
+        LOG_WRN("Discarding malformed peripheral event of type %d", ev.type);
+        return;
+    }
+
+    switch (ev.type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+        track_key_event(ev.data.key_position_event.position, ev.data.key_position_event.pressed,
+                        ev.data.key_position_event.timestamp);
+        break;
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT:
+        track_key_event(ev.data.keycode_event.position, ev.data.keycode_event.pressed,
+                        ev.data.keycode_event.timestamp);
+        break;
+    default:
+        break;
+    }
+
+    zmk_split_transport_central_peripheral_event_handler(&wired_central_transport,
+                                                         WIRED_PERIPHERAL_SOURCE, ev);
+}
+
+static const struct zmk_split_transport_central_api wired_central_api = {
+    .send_command = wired_send_command,
+    .get_available_source_ids = wired_get_available_source_ids,
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(wired_central_transport, &wired_central_api);
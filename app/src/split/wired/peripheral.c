@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/split/transport/peripheral.h>
+
+#include "wired.h"
+
+extern const struct zmk_split_transport_peripheral wired_peripheral_transport;
+
+static int wired_report_event(const struct zmk_split_transport_peripheral_event *ev) {
+    const size_t len = zmk_split_wired_peripheral_event_size(ev);
+    if (len == 0) {
+        return -ENOTSUP;
+    }
+
+    return zmk_split_wired_send(ev, len);
+}
+
+static void heartbeat_work_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(heartbeat_work, heartbeat_work_callback);
+
+// The central considers the link down if it hears nothing for a while, so say hello while idle.
+static void heartbeat_work_callback(struct k_work *work) {
+    int err = zmk_split_wired_send(NULL, 0);
+    if (err < 0) {
+        LOG_DBG("Failed to send heartbeat (%d)", err);
+    }
+
+    k_work_schedule(&heartbeat_work, K_MSEC(CONFIG_ZMK_SPLIT_WIRED_HEARTBEAT_INTERVAL_MS));
+}
+
+void zmk_split_wired_handle_message(const uint8_t *payload, size_t len) {
+    struct zmk_split_transport_central_command cmd = {0};
+
+    if (len == 0) {
+        return;
+    }
+
+    if (len > sizeof(cmd)) {
+        LOG_WRN("Discarding oversized central command (%zu bytes)", len);
+        return;
+    }
+
+    memcpy(&cmd, payload, len);
+
+    if (zmk_split_wired_central_command_size(&cmd) != len) {
+        LOG_WRN("Discarding malformed central command of type %d", cmd.type);
+        return;
+    }
+
+    zmk_split_transport_peripheral_command_handler(&wired_peripheral_transport, cmd);
+}
+
+static const struct zmk_split_transport_peripheral_api wired_peripheral_api = {
+    .report_event = wired_report_event,
+};
+
+ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(wired_peripheral_transport, &wired_peripheral_api);
+
+static int zmk_split_wired_peripheral_init(void) {
+    k_work_schedule(&heartbeat_work, K_NO_WAIT);
+    return 0;
+}
+
+SYS_INIT(zmk_split_wired_peripheral_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/ring_buffer.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include "wired.h"
+
+#define SPLIT_UART_NODE DT_CHOSEN(zmk_split_uart)
+
+static const struct device *const uart_dev = DEVICE_DT_GET(SPLIT_UART_NODE);
+
+// Worst case, every payload and CRC byte needs an escape byte.
+#define MAX_FRAME_SIZE (2 * (ZMK_SPLIT_WIRED_MAX_PAYLOAD_SIZE + sizeof(uint16_t)) + 2)
+
+RING_BUF_DECLARE(rx_buf, CONFIG_ZMK_SPLIT_WIRED_RX_BUF_SIZE);
+
+#if IS_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN)
+RING_BUF_DECLARE(tx_buf, CONFIG_ZMK_SPLIT_WIRED_TX_BUF_SIZE);
+#endif
+
+static K_MUTEX_DEFINE(tx_mutex);
+
+static size_t frame_put(uint8_t *frame, size_t len, uint8_t c) {
+    switch (c) {
+    case ZMK_SPLIT_WIRED_FRAMING_SOF:
+    case ZMK_SPLIT_WIRED_FRAMING_ESC:
+    case ZMK_SPLIT_WIRED_FRAMING_EOF:
+        frame[len++] = ZMK_SPLIT_WIRED_FRAMING_ESC;
+        break;
+    default:
+        break;
+    }
+
+    frame[len++] = c;
+    return len;
+}
+
+static int tx_frame(const uint8_t *frame, size_t len) {
+#if IS_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN)
+    if (ring_buf_space_get(&tx_buf) < len) {
+        LOG_WRN("Dropping split message, insufficient room in the TX buffer. Bump "
+                "CONFIG_ZMK_SPLIT_WIRED_TX_BUF_SIZE.");
+        return -ENOMEM;
+    }
+
+    ring_buf_put(&tx_buf, frame, len);
+    uart_irq_tx_enable(uart_dev);
+#else
+    for (size_t i = 0; i < len; i++) {
+        uart_poll_out(uart_dev, frame[i]);
+    }
+#endif
+
+    return 0;
+}
+
+int zmk_split_wired_send(const void *payload, size_t len) {
+    if (len > ZMK_SPLIT_WIRED_MAX_PAYLOAD_SIZE) {
+        return -EINVAL;
+    }
+
+    uint8_t frame[MAX_FRAME_SIZE];
+    uint8_t crc[sizeof(uint16_t)];
+    size_t frame_len = 0;
+
+    sys_put_le16(crc16_ansi(payload, len), crc);
+
+    frame[frame_len++] = ZMK_SPLIT_WIRED_FRAMING_SOF;
+    for (size_t i = 0; i < len; i++) {
+        frame_len = frame_put(frame, frame_len, ((const uint8_t *)payload)[i]);
+    }
+    for (size_t i = 0; i < sizeof(crc); i++) {
+        frame_len = frame_put(frame, frame_len, crc[i]);
+    }
+    frame[frame_len++] = ZMK_SPLIT_WIRED_FRAMING_EOF;
+
+    k_mutex_lock(&tx_mutex, K_FOREVER);
+    int ret = tx_frame(frame, frame_len);
+    k_mutex_unlock(&tx_mutex);
+
+    return ret;
+}
+
+enum split_wired_framing_state {
+    FRAMING_STATE_IDLE,
+    FRAMING_STATE_AWAITING_DATA,
+    FRAMING_STATE_ESCAPED,
+};
+
+static enum split_wired_framing_state rx_framing_state;
+static uint8_t rx_msg[ZMK_SPLIT_WIRED_MAX_PAYLOAD_SIZE + sizeof(uint16_t)];
+static size_t rx_msg_len;
+
+static void rx_msg_append(uint8_t c) {
+    if (rx_msg_len >= sizeof(rx_msg)) {
+        LOG_WRN("Discarding oversized split message");
+        rx_framing_state = FRAMING_STATE_IDLE;
+        return;
+    }
+
+    rx_msg[rx_msg_len++] = c;
+}
+
+static void rx_msg_done(void) {
+    if (rx_msg_len < sizeof(uint16_t)) {
+        LOG_WRN("Discarding truncated split message");
+        return;
+    }
+
+    const size_t len = rx_msg_len - sizeof(uint16_t);
+    if (crc16_ansi(rx_msg, len) != sys_get_le16(&rx_msg[len])) {
+        LOG_WRN("Discarding split message with bad CRC");
+        return;
+    }
+
+    zmk_split_wired_handle_message(rx_msg, len);
+}
+
+static void rx_process_byte(uint8_t c) {
+    switch (rx_framing_state) {
+    case FRAMING_STATE_IDLE:
+        // Anything before a SOF is noise, or the tail of a message that started before we did.
+        if (c == ZMK_SPLIT_WIRED_FRAMING_SOF) {
+            rx_msg_len = 0;
+            rx_framing_state = FRAMING_STATE_AWAITING_DATA;
+        }
+        break;
+    case FRAMING_STATE_AWAITING_DATA:
+        switch (c) {
+        case ZMK_SPLIT_WIRED_FRAMING_SOF:
+            LOG_WRN("Unescaped SOF mid-data, starting over");
+            rx_msg_len = 0;
+            break;
+        case ZMK_SPLIT_WIRED_FRAMING_ESC:
+            rx_framing_state = FRAMING_STATE_ESCAPED;
+            break;
+        case ZMK_SPLIT_WIRED_FRAMING_EOF:
+            rx_framing_state = FRAMING_STATE_IDLE;
+            rx_msg_done();
+            break;
+        default:
+            rx_msg_append(c);
+            break;
+        }
+        break;
+    case FRAMING_STATE_ESCAPED:
+        rx_framing_state = FRAMING_STATE_AWAITING_DATA;
+        rx_msg_append(c);
+        break;
+    }
+}
+
+static void rx_work_callback(struct k_work *work) {
+    uint8_t *data;
+    uint32_t len;
+
+    while ((len = ring_buf_get_claim(&rx_buf, &data, ring_buf_capacity_get(&rx_buf))) > 0) {
+        for (uint32_t i = 0; i < len; i++) {
+            rx_process_byte(data[i]);
+        }
+
+        ring_buf_get_finish(&rx_buf, len);
+    }
+}
+
+static K_WORK_DEFINE(rx_work, rx_work_callback);
+
+#if IS_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN)
+
+static void serial_cb(const struct device *dev, void *user_data) {
+    if (!uart_irq_update(dev)) {
+        return;
+    }
+
+    if (uart_irq_rx_ready(dev)) {
+        uint32_t last_read = 0, len = 0;
+        do {
+            uint8_t *buffer;
+            len = ring_buf_put_claim(&rx_buf, &buffer, ring_buf_capacity_get(&rx_buf));
+            if (len > 0) {
+                last_read = uart_fifo_read(dev, buffer, len);
+                ring_buf_put_finish(&rx_buf, last_read);
+            } else {
+                LOG_ERR("Dropping incoming split byte, insufficient room in the RX buffer. Bump "
+                        "CONFIG_ZMK_SPLIT_WIRED_RX_BUF_SIZE.");
+                uint8_t dummy;
+                last_read = uart_fifo_read(dev, &dummy, 1);
+            }
+        } while (last_read && last_read == len);
+
+        k_work_submit(&rx_work);
+    }
+
+    if (uart_irq_tx_ready(dev)) {
+        uint8_t *buf;
+        uint32_t claim_len = ring_buf_get_claim(&tx_buf, &buf, ring_buf_capacity_get(&tx_buf));
+
+        if (claim_len == 0) {
+            uart_irq_tx_disable(dev);
+            return;
+        }
+
+        int sent = uart_fifo_fill(dev, buf, claim_len);
+        ring_buf_get_finish(&tx_buf, MAX(sent, 0));
+    }
+}
+
+#else
+
+static void split_wired_rx_main(void) {
+    for (;;) {
+        bool received = false;
+        uint8_t c;
+
+        while (uart_poll_in(uart_dev, &c) == 0) {
+            if (ring_buf_put(&rx_buf, &c, 1) == 0) {
+                LOG_ERR("Dropping incoming split byte, insufficient room in the RX buffer. Bump "
+                        "CONFIG_ZMK_SPLIT_WIRED_RX_BUF_SIZE.");
+            }
+            received = true;
+        }
+
+        if (received) {
+            k_work_submit(&rx_work);
+        }
+
+        k_sleep(K_MSEC(1));
+    }
+}
+
+K_THREAD_DEFINE(split_wired_rx_thread, CONFIG_ZMK_SPLIT_WIRED_RX_STACK_SIZE, split_wired_rx_main,
+                NULL, NULL, NULL, K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
+#endif // IS_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN)
+
+static int zmk_split_wired_init(void) {
+    if (!device_is_ready(uart_dev)) {
+        LOG_ERR("Split UART device not ready");
+        return -ENODEV;
+    }
+
+#if IS_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN)
+    int ret = uart_irq_callback_user_data_set(uart_dev, serial_cb, NULL);
+    if (ret < 0) {
+        LOG_ERR("Failed to set split UART callback (err %d)", ret);
+        return ret;
+    }
+
+    uart_irq_rx_enable(uart_dev);
+#endif // IS_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN)
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_wired_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
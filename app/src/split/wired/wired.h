@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#include <zmk/split/transport/types.h>
+
+/*
+ * Messages are framed like studio RPC messages: a start byte, the payload with any framing bytes
+ * escaped, then an end byte. The payload is a peripheral event or central command, trimmed to
+ * the size of its type, followed by a little-endian CRC-16 of the unescaped payload. A message
+ * with an empty payload is a heartbeat, which the peripheral sends so the central can tell it's
+ * still connected while no keys change.
+ */
+#define ZMK_SPLIT_WIRED_FRAMING_SOF 0xAB
+#define ZMK_SPLIT_WIRED_FRAMING_ESC 0xAC
+#define ZMK_SPLIT_WIRED_FRAMING_EOF 0xAD
+
+#define ZMK_SPLIT_WIRED_MAX_PAYLOAD_SIZE                                                           \
+    MAX(sizeof(struct zmk_split_transport_peripheral_event),                                       \
+        sizeof(struct zmk_split_transport_central_command))
+
+/**
+ * Frame a message and send it to the other half. May be called from any thread.
+ *
+ * @retval 0 on success.
+ * @retval -ENOMEM if there is no room in the TX buffer for the whole frame.
+ */
+int zmk_split_wired_send(const void *payload, size_t len);
+
+/**
+ * Called on the system work queue for each message received with a valid CRC. Implemented by
+ * the central or peripheral side of the transport.
+ */
+void zmk_split_wired_handle_message(const uint8_t *payload, size_t len);
+
+/**
+ * @return The number of bytes of an event that need to be sent, or 0 if the type is unknown.
+ */
+static inline size_t
+zmk_split_wired_peripheral_event_size(const struct zmk_split_transport_peripheral_event *ev) {
+    switch (ev->type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+        return offsetof(struct zmk_split_transport_peripheral_event, data) +
+               sizeof(ev->data.key_position_event);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
+        return offsetof(struct zmk_split_transport_peripheral_event,
+                        data.sensor_event.channel_data) +
+               MIN(ev->data.sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS) *
+                   sizeof(struct zmk_sensor_channel_data);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT:
+        return offsetof(struct zmk_split_transport_peripheral_event, data) +
+               sizeof(ev->data.input_event);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_FRAME:
+        return offsetof(struct zmk_split_transport_peripheral_event, data) +
+               sizeof(ev->data.input_frame);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEYCODE_EVENT:
+        return offsetof(struct zmk_split_transport_peripheral_event, data) +
+               sizeof(ev->data.keycode_event);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @return The number of bytes of a command that need to be sent, or 0 if the type is unknown.
+ */
+static inline size_t
+zmk_split_wired_central_command_size(const struct zmk_split_transport_central_command *cmd) {
+    switch (cmd->type) {
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR:
+        // Only send the behavior label up to and including its terminator.
+        return offsetof(struct zmk_split_transport_central_command,
+                        data.invoke_behavior.behavior_dev) +
+               strnlen(cmd->data.invoke_behavior.behavior_dev,
+                       ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN - 1) +
+               1;
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
+        return offsetof(struct zmk_split_transport_central_command, data) +
+               sizeof(cmd->data.set_physical_layout);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_STATE_SYNC:
+        return offsetof(struct zmk_split_transport_central_command, data) +
+               sizeof(cmd->data.state_sync);
+    default:
+        return 0;
+    }
+}
@@ -55,9 +55,12 @@ bool zmk_usb_is_hid_ready(void) {
 }
 
 void usb_status_cb(enum usb_dc_status_code status, const uint8_t *params) {
-    // Start-of-frame events are too frequent and noisy to notify, and they're
-    // not used within ZMK
+    // Start-of-frame events are too frequent and noisy to notify, and are only
+    // used to align HID report writes to frames
     if (status == USB_DC_SOF) {
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+        zmk_usb_hid_sof();
+#endif
         return;
     }
 
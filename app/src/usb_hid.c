@@ -4,15 +4,20 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <string.h>
+
 #include <zephyr/device.h>
 #include <zephyr/init.h>
+#include <zephyr/kernel.h>
 
 #include <zephyr/usb/usb_device.h>
 #include <zephyr/usb/class/usb_hid.h>
 
 #include <zmk/usb.h>
+#include <zmk/usb_hid.h>
 #include <zmk/hid.h>
 #include <zmk/keymap.h>
+#include <zmk/endpoints.h>
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 #include <zmk/pointing/resolution_multipliers.h>
@@ -30,7 +35,14 @@ static const struct device *hid_dev;
 
 static K_SEM_DEFINE(hid_sem, 1, 1);
 
-static void in_ready_cb(const struct device *dev) { k_sem_give(&hid_sem); }
+static void usb_hid_record_read(void);
+static void usb_hid_send_next(void);
+
+static void in_ready_cb(const struct device *dev) {
+    usb_hid_record_read();
+    k_sem_give(&hid_sem);
+    usb_hid_send_next();
+}
 
 #define HID_GET_REPORT_TYPE_MASK 0xff00
 #define HID_GET_REPORT_ID_MASK 0x00ff
@@ -60,6 +72,21 @@ static uint8_t *get_keyboard_report(size_t *len) {
     return (uint8_t *)report;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+static bool use_keyboard_hkro_report(void) {
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    // The boot report replaces both keyboard reports while the host uses the boot protocol.
+    if (hid_protocol != HID_PROTOCOL_REPORT) {
+        return false;
+    }
+#endif
+    struct zmk_endpoint_instance endpoint = {
+        .transport = ZMK_TRANSPORT_USB,
+    };
+    return zmk_endpoints_keyboard_report_type(endpoint) == ZMK_HID_KEYBOARD_REPORT_TYPE_HKRO;
+}
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
 static int get_report_cb(const struct device *dev, struct usb_setup_packet *setup, int32_t *len,
                          uint8_t **data) {
     switch (setup->wValue & HID_GET_REPORT_TYPE_MASK) {
@@ -98,6 +125,14 @@ static int get_report_cb(const struct device *dev, struct usb_setup_packet *setu
             *len = sizeof(*report);
             break;
         }
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+        case ZMK_HID_REPORT_ID_KEYBOARD_HKRO: {
+            struct zmk_hid_keyboard_hkro_report *report = zmk_hid_get_keyboard_hkro_report();
+            *data = (uint8_t *)report;
+            *len = sizeof(*report);
+            break;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
         default:
             LOG_ERR("Invalid report ID %d requested", setup->wValue & HID_GET_REPORT_ID_MASK);
             return -EINVAL;
@@ -182,7 +217,224 @@ static const struct hid_ops ops = {
     .set_report = set_report_cb,
 };
 
-static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
+/*
+ * Reports are copied into a queue per report ID and written to the interrupt endpoint from a
+ * dedicated work queue, so a slow host never blocks the caller. A report is only written once the
+ * endpoint is free, which lets reports raised while waiting be collapsed into the one still queued,
+ * and only leaves its queue once the endpoint accepts it, so a failed write is retried.
+ */
+
+// Only used for its size, which fits any report this file sends.
+union usb_hid_any_report {
+    struct zmk_hid_keyboard_report keyboard;
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    zmk_hid_boot_report_t boot;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    struct zmk_hid_keyboard_hkro_report keyboard_hkro;
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    struct zmk_hid_consumer_report consumer;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct zmk_hid_mouse_report mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
+
+struct usb_hid_report {
+    uint8_t len;
+    // Cycle count when the report was queued. Merging newer state into it keeps this, so it is
+    // the age of the oldest state in the report.
+    uint32_t queued_at;
+    uint8_t data[sizeof(union usb_hid_any_report)];
+};
+
+/**
+ * Merge a newly raised report into the newest queued one.
+ *
+ * @param full Whether the queue has no space left for the new report.
+ * @return true if the new report was merged and needs no queue slot of its own.
+ */
+typedef bool (*usb_hid_report_merge_t)(uint8_t *queued, const uint8_t *report, size_t len,
+                                       bool full);
+
+struct usb_hid_report_queue {
+    struct usb_hid_report *reports;
+    uint8_t size;
+    uint8_t head;
+    uint8_t count;
+    // Whether the oldest report is being written. It stays queued until the write succeeds, so
+    // newer state must not be merged into it.
+    bool writing;
+    usb_hid_report_merge_t merge;
+    // Whether to hold reports until the next start of frame, see CONFIG_ZMK_USB_HID_SOF_FLUSH.
+    bool frame_aligned;
+    struct zmk_usb_hid_queue_stats stats;
+    uint64_t staleness_total_us;
+    uint32_t staleness_samples;
+};
+
+static struct k_spinlock queue_lock;
+
+// The report written to the endpoint that the host has yet to read.
+static struct usb_hid_report_queue *in_flight_queue;
+static uint32_t in_flight_queued_at;
+
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+// Frames stop while the bus is suspended, so hold reports for at most as long as one frame takes.
+#define USB_HID_FRAME_TIMEOUT_MS 2
+
+static uint32_t frames;
+// Whether a frame started since the host read the last report, and when the host read it.
+static bool frame_started = true;
+static int64_t frame_wait_start;
+// Whether frame-aligned reports are held until the next frame starts.
+static bool frame_held;
+
+void zmk_usb_hid_sof(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    frames++;
+    frame_started = true;
+    const bool held = frame_held;
+    frame_held = false;
+    k_spin_unlock(&queue_lock, key);
+
+    if (held) {
+        usb_hid_send_next();
+    }
+}
+
+static bool usb_hid_frame_started(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    const bool started =
+        frame_started || k_uptime_get() - frame_wait_start >= USB_HID_FRAME_TIMEOUT_MS;
+    k_spin_unlock(&queue_lock, key);
+
+    return started;
+}
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+static void usb_hid_record_read(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+    frame_started = false;
+    frame_wait_start = k_uptime_get();
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+    struct usb_hid_report_queue *queue = in_flight_queue;
+    if (queue) {
+        const uint32_t staleness_us = k_cyc_to_us_floor32(k_cycle_get_32() - in_flight_queued_at);
+
+        queue->staleness_total_us += staleness_us;
+        queue->staleness_samples++;
+        queue->stats.staleness_max_us = MAX(queue->stats.staleness_max_us, staleness_us);
+        in_flight_queue = NULL;
+    }
+
+    k_spin_unlock(&queue_lock, key);
+}
+
+static void usb_hid_queue_push(struct usb_hid_report_queue *queue, const uint8_t *data,
+                               size_t len) {
+    __ASSERT_NO_MSG(len <= sizeof(queue->reports[0].data));
+
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    queue->stats.queued++;
+
+    if (queue->count > (queue->writing ? 1 : 0) && queue->merge) {
+        struct usb_hid_report *newest =
+            &queue->reports[(queue->head + queue->count - 1) % queue->size];
+
+        if (newest->len == len &&
+            queue->merge(newest->data, data, len, queue->count == queue->size)) {
+            queue->stats.collapsed++;
+            k_spin_unlock(&queue_lock, key);
+            return;
+        }
+    }
+
+    // Full queues merge, unless the newest report has another length, e.g. after a protocol switch.
+    if (queue->count == queue->size) {
+        LOG_WRN("USB HID report queue full, dropping the oldest report");
+        if (queue->writing && queue->size > 1) {
+            // Keep the report being written in place of the one after it.
+            queue->reports[(queue->head + 1) % queue->size] = queue->reports[queue->head];
+        } else {
+            // The slot of the report being written, if any, now holds the new report.
+            queue->writing = false;
+        }
+        queue->head = (queue->head + 1) % queue->size;
+        queue->count--;
+        queue->stats.dropped++;
+    }
+
+    struct usb_hid_report *report = &queue->reports[(queue->head + queue->count) % queue->size];
+    report->len = len;
+    report->queued_at = k_cycle_get_32();
+    memcpy(report->data, data, len);
+
+    queue->count++;
+    queue->stats.max_depth = MAX(queue->stats.max_depth, queue->count);
+
+    k_spin_unlock(&queue_lock, key);
+}
+
+static bool usb_hid_queue_peek(struct usb_hid_report_queue *queue, struct usb_hid_report *report) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    if (queue->count == 0) {
+        k_spin_unlock(&queue_lock, key);
+        return false;
+    }
+
+    *report = queue->reports[queue->head];
+    queue->writing = true;
+
+    // Set before the write, since the host may read the report before the write returns.
+    in_flight_queue = queue;
+    in_flight_queued_at = report->queued_at;
+
+    k_spin_unlock(&queue_lock, key);
+
+    return true;
+}
+
+static void usb_hid_queue_record_write(struct usb_hid_report_queue *queue, int err) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    if (err) {
+        queue->stats.failed++;
+        in_flight_queue = NULL;
+    } else {
+        // Only a report the endpoint accepted leaves the queue.
+        if (queue->writing) {
+            queue->head = (queue->head + 1) % queue->size;
+            queue->count--;
+        }
+        queue->stats.sent++;
+    }
+
+    queue->writing = false;
+
+    k_spin_unlock(&queue_lock, key);
+}
+
+static void usb_hid_queue_purge(struct usb_hid_report_queue *queue) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    queue->stats.dropped += queue->count;
+    queue->head = 0;
+    queue->count = 0;
+
+    k_spin_unlock(&queue_lock, key);
+}
+
+K_THREAD_STACK_DEFINE(usb_hid_q_stack, CONFIG_ZMK_USB_HID_THREAD_STACK_SIZE);
+
+static struct k_work_q usb_hid_work_q;
+
+static int zmk_usb_hid_send_report(struct usb_hid_report_queue *queue, const uint8_t *report,
+                                   size_t len) {
     switch (zmk_usb_get_status()) {
     case USB_DC_SUSPEND:
         return usb_wakeup_request();
@@ -192,21 +444,271 @@ static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
     case USB_DC_UNKNOWN:
         return -ENODEV;
     default:
-        k_sem_take(&hid_sem, K_MSEC(30));
-        int err = hid_int_ep_write(hid_dev, report, len, NULL);
+        usb_hid_queue_push(queue, report, len);
+        usb_hid_send_next();
+        return 0;
+    }
+}
+
+// Every keyboard report is a key change the host must see, so these are only merged once the queue
+// is full. The newest report then takes the latest state, so the host may miss a change in between
+// but never ends up with a stale one, e.g. a key left pressed.
+static bool merge_keyboard_report(uint8_t *queued, const uint8_t *report, size_t len, bool full) {
+    if (!full) {
+        return false;
+    }
 
-        if (err) {
-            k_sem_give(&hid_sem);
+    memcpy(queued, report, len);
+    return true;
+}
+
+static struct usb_hid_report keyboard_reports[CONFIG_ZMK_USB_HID_KEYBOARD_REPORT_QUEUE_SIZE];
+
+static struct usb_hid_report_queue keyboard_queue = {
+    .reports = keyboard_reports,
+    .size = ARRAY_SIZE(keyboard_reports),
+    .merge = merge_keyboard_report,
+};
+
+
+static bool merge_consumer_report(uint8_t *queued, const uint8_t *report, size_t len,
+                                  bool full) {
+    if (!full && memcmp(queued, report, sizeof(struct zmk_hid_consumer_report)) != 0) {
+        return false;
+    }
+
+    memcpy(queued, report, sizeof(struct zmk_hid_consumer_report));
+    return true;
+}
+
+static struct usb_hid_report consumer_reports[CONFIG_ZMK_USB_HID_CONSUMER_REPORT_QUEUE_SIZE];
+
+static struct usb_hid_report_queue consumer_queue = {
+    .reports = consumer_reports,
+    .size = ARRAY_SIZE(consumer_reports),
+    .merge = merge_consumer_report,
+    .frame_aligned = true,
+};
+
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+
+static bool merge_mouse_report(uint8_t *queued, const uint8_t *report, size_t len, bool full) {
+    struct zmk_hid_mouse_report_body *body = &((struct zmk_hid_mouse_report *)queued)->body;
+    const struct zmk_hid_mouse_report_body *new_body =
+        &((const struct zmk_hid_mouse_report *)report)->body;
+
+    const int32_t d_x = body->d_x + new_body->d_x;
+    const int32_t d_y = body->d_y + new_body->d_y;
+    const int32_t d_scroll_y = body->d_scroll_y + new_body->d_scroll_y;
+    const int32_t d_scroll_x = body->d_scroll_x + new_body->d_scroll_x;
+
+    // Button changes and movement that doesn't fit one report are kept as separate reports while
+    // there is room, so no click or movement is lost.
+    if (!full && (body->buttons != new_body->buttons || !IN_RANGE(d_x, INT16_MIN, INT16_MAX) ||
+                  !IN_RANGE(d_y, INT16_MIN, INT16_MAX) ||
+                  !IN_RANGE(d_scroll_y, INT16_MIN, INT16_MAX) ||
+                  !IN_RANGE(d_scroll_x, INT16_MIN, INT16_MAX))) {
+        return false;
+    }
+
+    body->buttons = new_body->buttons;
+    body->d_x = CLAMP(d_x, INT16_MIN, INT16_MAX);
+    body->d_y = CLAMP(d_y, INT16_MIN, INT16_MAX);
+    body->d_scroll_y = CLAMP(d_scroll_y, INT16_MIN, INT16_MAX);
+    body->d_scroll_x = CLAMP(d_scroll_x, INT16_MIN, INT16_MAX);
+    return true;
+}
+
+static struct usb_hid_report mouse_reports[CONFIG_ZMK_USB_HID_MOUSE_REPORT_QUEUE_SIZE];
+
+static struct usb_hid_report_queue mouse_queue = {
+    .reports = mouse_reports,
+    .size = ARRAY_SIZE(mouse_reports),
+    .merge = merge_mouse_report,
+    .frame_aligned = true,
+};
+
+
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+
+// A single work item writes one report from each queue in turn, so a queue that keeps refilling,
+// e.g. the mouse queue with a trackball attached, can't hold up keyboard reports.
+static struct usb_hid_report_queue *const queues[] = {
+    &keyboard_queue,
+    &consumer_queue,
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    &mouse_queue,
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
+
+// How long the host gets to read a report before the endpoint is assumed to be free again, e.g.
+// after a bus reset dropped the report without an IN ready callback.
+#define USB_HID_IN_READY_TIMEOUT_MS 30
+
+// How long to wait before writing a report again after the endpoint failed to accept it.
+#define USB_HID_RETRY_DELAY_MS 10
+
+static size_t next_queue;
+static int64_t last_write_time;
+
+static void send_next_report_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(usb_hid_send_work, send_next_report_callback);
+
+static void usb_hid_send_next(void) {
+    k_work_reschedule_for_queue(&usb_hid_work_q, &usb_hid_send_work, K_NO_WAIT);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+// Send the held frame-aligned reports once the next frame starts, or after
+// USB_HID_FRAME_TIMEOUT_MS if no frame starts.
+static void usb_hid_send_next_frame(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    const bool started = frame_started;
+    frame_held = !started;
+    const int64_t remaining = frame_wait_start + USB_HID_FRAME_TIMEOUT_MS - k_uptime_get();
+    k_spin_unlock(&queue_lock, key);
+
+    if (started) {
+        usb_hid_send_next();
+        return;
+    }
+
+    k_work_schedule_for_queue(&usb_hid_work_q, &usb_hid_send_work, K_MSEC(MAX(remaining, 0)));
+}
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+static void send_next_report_callback(struct k_work *work) {
+    if (k_sem_take(&hid_sem, K_NO_WAIT) != 0) {
+        const int64_t waited = k_uptime_get() - last_write_time;
+        if (waited < USB_HID_IN_READY_TIMEOUT_MS) {
+            // The IN ready callback sends the next report once the host reads this one.
+            k_work_schedule_for_queue(&usb_hid_work_q, &usb_hid_send_work,
+                                      K_MSEC(USB_HID_IN_READY_TIMEOUT_MS - waited));
+            return;
+        }
+
+        LOG_WRN("Host didn't read the last USB HID report in %d ms", USB_HID_IN_READY_TIMEOUT_MS);
+        k_spinlock_key_t key = k_spin_lock(&queue_lock);
+        in_flight_queue = NULL;
+        k_spin_unlock(&queue_lock, key);
+    }
+
+    struct usb_hid_report_queue *queue = NULL;
+    struct usb_hid_report report;
+
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+    const bool frame_ready = usb_hid_frame_started();
+    bool held = false;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+    for (size_t i = 0; i < ARRAY_SIZE(queues); i++) {
+        struct usb_hid_report_queue *candidate = queues[(next_queue + i) % ARRAY_SIZE(queues)];
+
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+        // Once the host has read the previous report, changes raised until the next frame starts
+        // are merged into the queued report, so the host reads the latest state in that frame.
+        if (candidate->frame_aligned && !frame_ready) {
+            held |= candidate->count > 0;
+            continue;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+        if (usb_hid_queue_peek(candidate, &report)) {
+            next_queue = (next_queue + i + 1) % ARRAY_SIZE(queues);
+            queue = candidate;
+            break;
+        }
+    }
+
+    if (queue == NULL) {
+        k_sem_give(&hid_sem);
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+        if (held) {
+            usb_hid_send_next_frame();
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+        return;
+    }
+
+    last_write_time = k_uptime_get();
+    int err = hid_int_ep_write(hid_dev, report.data, report.len, NULL);
+    usb_hid_queue_record_write(queue, err);
+
+    if (err) {
+        k_sem_give(&hid_sem);
+
+        if (!zmk_usb_is_hid_ready()) {
+            LOG_WRN("Dropping queued USB HID reports, the host isn't listening (%d)", err);
+            for (size_t i = 0; i < ARRAY_SIZE(queues); i++) {
+                usb_hid_queue_purge(queues[i]);
+            }
+            return;
         }
 
-        return err;
+        LOG_DBG("Error writing HID report %d, retrying", err);
+        k_work_schedule_for_queue(&usb_hid_work_q, &usb_hid_send_work,
+                                  K_MSEC(USB_HID_RETRY_DELAY_MS));
     }
 }
 
+static void get_queue_stats(const struct usb_hid_report_queue *queue,
+                            struct zmk_usb_hid_queue_stats *stats) {
+    *stats = queue->stats;
+    stats->depth = queue->count;
+    stats->staleness_avg_us =
+        queue->staleness_samples ? queue->staleness_total_us / queue->staleness_samples : 0;
+}
+
+void zmk_usb_hid_get_stats(struct zmk_usb_hid_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    get_queue_stats(&keyboard_queue, &stats->keyboard);
+    get_queue_stats(&consumer_queue, &stats->consumer);
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    get_queue_stats(&mouse_queue, &stats->mouse);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+    stats->frames = frames;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+    k_spin_unlock(&queue_lock, key);
+}
+
+static void reset_queue_stats(struct usb_hid_report_queue *queue) {
+    queue->stats = (struct zmk_usb_hid_queue_stats){.max_depth = queue->count};
+    queue->staleness_total_us = 0;
+    queue->staleness_samples = 0;
+}
+
+void zmk_usb_hid_reset_stats(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    reset_queue_stats(&keyboard_queue);
+    reset_queue_stats(&consumer_queue);
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    reset_queue_stats(&mouse_queue);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+    frames = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+    k_spin_unlock(&queue_lock, key);
+}
+
 int zmk_usb_hid_send_keyboard_report(void) {
+#if IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+    if (use_keyboard_hkro_report()) {
+        struct zmk_hid_keyboard_hkro_report *hkro_report = zmk_hid_get_keyboard_hkro_report();
+        return zmk_usb_hid_send_report(&keyboard_queue, (uint8_t *)hkro_report,
+                                       sizeof(*hkro_report));
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_HID_KEYBOARD_HKRO_REPORT)
+
     size_t len;
     uint8_t *report = get_keyboard_report(&len);
-    return zmk_usb_hid_send_report(report, len);
+    return zmk_usb_hid_send_report(&keyboard_queue, report, len);
 }
 
 int zmk_usb_hid_send_consumer_report(void) {
@@ -217,7 +719,7 @@ int zmk_usb_hid_send_consumer_report(void) {
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
     struct zmk_hid_consumer_report *report = zmk_hid_get_consumer_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    return zmk_usb_hid_send_report(&consumer_queue, (uint8_t *)report, sizeof(*report));
 }
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
@@ -229,11 +731,15 @@ int zmk_usb_hid_send_mouse_report() {
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
     struct zmk_hid_mouse_report *report = zmk_hid_get_mouse_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    return zmk_usb_hid_send_report(&mouse_queue, (uint8_t *)report, sizeof(*report));
 }
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
 static int zmk_usb_hid_init(void) {
+    static const struct k_work_queue_config queue_config = {.name = "USB HID Send Work"};
+    k_work_queue_start(&usb_hid_work_q, usb_hid_q_stack, K_THREAD_STACK_SIZEOF(usb_hid_q_stack),
+                       CONFIG_ZMK_USB_HID_THREAD_PRIORITY, &queue_config);
+
     hid_dev = device_get_binding("HID_0");
     if (hid_dev == NULL) {
         LOG_ERR("Unable to locate HID device");
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/shell/shell.h>
+
+#include <zmk/usb_hid.h>
+
+static void print_queue_stats(const struct shell *sh, const char *name,
+                              const struct zmk_usb_hid_queue_stats *stats) {
+    shell_print(sh, "%s reports:", name);
+    shell_print(sh, "  queued:    %u", stats->queued);
+    shell_print(sh, "  sent:      %u", stats->sent);
+    shell_print(sh, "  failed:    %u", stats->failed);
+    shell_print(sh, "  collapsed: %u", stats->collapsed);
+    shell_print(sh, "  dropped:   %u", stats->dropped);
+    shell_print(sh, "  depth:     %u, max %u", stats->depth, stats->max_depth);
+    shell_print(sh, "  staleness: avg %u us, max %u us", stats->staleness_avg_us,
+                stats->staleness_max_us);
+}
+
+static int cmd_usb_hid_stats(const struct shell *sh, size_t argc, char **argv) {
+    struct zmk_usb_hid_stats stats;
+    zmk_usb_hid_get_stats(&stats);
+
+    print_queue_stats(sh, "Keyboard", &stats.keyboard);
+    print_queue_stats(sh, "Consumer", &stats.consumer);
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    print_queue_stats(sh, "Mouse", &stats.mouse);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+    shell_print(sh, "Frames: %u", stats.frames);
+#endif // IS_ENABLED(CONFIG_ZMK_USB_HID_SOF_FLUSH)
+
+    return 0;
+}
+
+static int cmd_usb_hid_stats_reset(const struct shell *sh, size_t argc, char **argv) {
+    zmk_usb_hid_reset_stats();
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_usb_hid_stats,
+                               SHELL_CMD(reset, NULL, "Reset USB HID report statistics",
+                                         cmd_usb_hid_stats_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_usb_hid,
+                               SHELL_CMD(stats, &sub_usb_hid_stats,
+                                         "Show USB HID report statistics", cmd_usb_hid_stats),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(usb_hid, &sub_usb_hid, "USB HID commands", NULL);